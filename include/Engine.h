@@ -5,11 +5,14 @@
 #pragma once
 
 #include <stdio.h>
+#include <chrono>
 #include "Renderer.h"
+#include "ResolutionScaler.h"
 #include "World.h"
 #include "Object.h"
 #include "ThreadPool.h"
 #include "RenderThread.h"
+#include "TaskGraph.h"
 
 
 
@@ -29,7 +32,18 @@ namespace Engine {
 	private:
 		bool isActive;				// Stores whether engine is initialized and active
 		int nRenderThreads;			// Number of threads
+		bool pinRenderThreads;		// Pin render threads to processors
+		bool isHeadless;			// Render without a window
 		Util::ThreadPool<Util::RenderThread> renderPool;	// Rendering thread pool
+		Util::TaskGraph<Util::ThreadPool<Util::RenderThread>> frameGraph;	// Stages of a frame
+		int renderNodeIdx = -1;		// Frame graph node tracing the tile batches
+		std::chrono::steady_clock::time_point frameDeadlineTime;	// Deadline of the frame in flight
+		Renderer::ResolutionScaler resolutionScaler;	// Render scale that keeps frames within the frame time budget
+		std::chrono::steady_clock::time_point lastFrameTime;	// Start of the previous DisplayFrame
+		double frameDeadline = 0;	// Seconds from the start of a frame until unfinished tiles fall back; 0 for none
+
+		//! Properties
+		static constexpr int outputRowGrain = 32;	// Rows per upscaling task
 
 		//! Sub-components
 		std::shared_ptr<World::World> world;
@@ -39,13 +53,24 @@ namespace Engine {
 		std::unique_ptr<Renderer::Renderer> renderer;
 
 	public:
-		Engine(int nRenderThreads);
+		Engine(int nRenderThreads, bool pinRenderThreads = false, bool isHeadless = false);
 		~Engine();
 		
 		//! Interface functions
 		bool Init();
+		bool AddMesh(const std::string& path, MaterialMgr::MATERIAL_ID materialID, Util::Transform& transform);
+		bool SetTileSize(int tileSize);
+		void SetFrameTimeBudget(double seconds);
+		bool SetFrameDeadline(double seconds);
+		bool SetTonemapSettings(const Renderer::TonemapSettings& settings);
+		bool SetProgressive(bool isProgressive);
+		bool SaveFrame(const std::string& path);
 		bool IsActive() const;
 		bool DisplayFrame();
+
+	private:
+		//! Helper functions
+		void _BuildFrameGraph();
 	};
 
 }; // namespace Engine
\ No newline at end of file
@@ -0,0 +1,37 @@
+//!
+//! Accumulator.h
+//! Progressive averaging of the radiance of successive frames of an unchanged view
+//!
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "HdrFrame.h"
+
+
+
+namespace Renderer {
+
+	//! Accumulator
+	//! Keeps the running mean of every sample traced for each pixel since the last reset. Samples are counted
+	//! per pixel, so tiles that are not traced in some frames keep correct weights
+	//!
+	class Accumulator {
+	private:
+		std::unique_ptr<HdrFrame> mean;
+		std::vector<uint32_t> sampleCounts;	// Samples in the mean of each pixel, rows the pitch of the mean apart
+		int nFrames = 0;					// Frames begun since the last reset
+
+	public:
+		//! Interface functions
+		void Reset(int width, int height);
+		void Clear();
+		void BeginFrame();
+		void AccumulateRect(HdrFrame& frame, int x, int y, int rectWidth, int rectHeight);
+
+		//! Accessors
+		int GetFrameCount() const { return nFrames; }
+		bool HasSize(int width, int height) const { return mean && mean->GetWidth() == width && mean->GetHeight() == height; }
+	};
+
+}; // namespace Renderer
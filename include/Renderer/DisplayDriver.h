@@ -5,6 +5,7 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <vector>
 #include "Util.h"
 #include "Frame.h"
 #include "InputMgr.h"
@@ -23,13 +24,12 @@ namespace Renderer {
 		//! SDL Objects
 		SDL_Window* window{};
 		SDL_Renderer* renderer{};
-		SDL_Texture* texture{};
+		std::vector<SDL_Texture*> textures;	// Streaming textures of the window size
 		SDL_Event event;
 
 		//! Internal variables
 		bool isInitialized = false;
-		void* pixels;	// Raw pixel buffer
-		int pitch;		// bytes per row of the pixel buffer
+		bool isSdlInitialized = false;
 		std::shared_ptr<InputMgr::InputMgr> inputMgr;
 
 	public:
@@ -38,11 +38,14 @@ namespace Renderer {
 		~DisplayDriver();
 
 		//! Initialization
-		bool Init();
+		bool Init(int nTextures = 1);
 
 		//! Interface functions
 		void PollEvents();
-		void RenderFrame(const Frame& frame);
+		void RenderFrame(const Frame& frame, int textureIdx = 0);
+		PixelView LockTexture(int textureIdx);
+		void UnlockTexture(int textureIdx);
+		void RenderTexture(int textureIdx);
 		
 		//! Accessors
 		bool IsActive() const;
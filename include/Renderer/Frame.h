@@ -6,31 +6,60 @@
 
 #include <cstdint>
 #include <tuple>
+#include "AlignedAllocator.h"
 #include "Util.h"
 
 
 
 namespace Renderer {
 
+	//! PixelView
+	//! Writable rectangle of packed RGBA8888 pixels, such as a frame or a locked display texture
+	//! 
+	struct PixelView {
+		uint32_t* pixels = nullptr;
+		int width = 0;
+		int height = 0;
+		int pitch = 0;		// Pixels from the start of one row to the start of the next
+	};
+
+	//! Frame
+	//! Rows start on a cache line and are padded to a whole number of lines, so render threads writing
+	//! different rows, or tiles whose edges fall on multiples of 16 pixels, never share a cache line
+	//! 
 	class Frame {
+	public:
+		static constexpr int rowAlignment = (int)(Util::cacheLineSize / sizeof(uint32_t));	// Pixels per cache line
+
 	private:
 		std::string name;
 		int width;
 		int height;
-		uint32_t* pixels;
+		int pitch;		// Pixels from the start of one row to the start of the next
+		Util::AlignedVector<uint32_t, Util::cacheLineSize> pixels;
 
 	public:
 		Frame(std::string name, int width, int height);
-		~Frame();
 
 		std::string GetName() const;
 		int GetWidth() const;
 		int GetHeight() const;
+		int GetPitch() const;
+		uint32_t* GetBuffer();
 		const uint32_t* GetBuffer() const;
+		PixelView GetView();
+		PixelView GetView(int x, int y, int viewWidth, int viewHeight);
+
+		//! Unchecked access to the pixels of a row, for writing spans without per-pixel bounds checks
+		uint32_t* GetRow(int y) { return pixels.data() + (size_t)y * pitch; }
+		const uint32_t* GetRow(int y) const { return pixels.data() + (size_t)y * pitch; }
 
 		void SetPixel(int x, int y, uint32_t color);
 		void SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a);
 		uint32_t GetPixel(int x, int y);
+		void ResampleFrom(const Frame& source);
+		void ResampleFrom(const Frame& source, int rowBegin, int rowEnd);
+		static void Resample(const Frame& source, const PixelView& target, int rowBegin, int rowEnd);
 
 	};
 
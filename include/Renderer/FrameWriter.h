@@ -0,0 +1,34 @@
+//!
+//! FrameWriter.h
+//! Writes rendered frames to image files
+//!
+#pragma once
+
+#include <string>
+#include "Util.h"
+#include "Frame.h"
+#include "HdrFrame.h"
+
+
+
+namespace Renderer {
+
+	namespace FrameWriter {
+
+		//! Write
+		//! Writes the frame to the given path, selecting the format by file extension (.ppm, .png or .pfm)
+		//! PFM stores the radiance of the HDR frame when one of the same size is given, otherwise the 8-bit
+		//! channels as floats in [0, 1]
+		//! Returns false on failure
+		//!
+		bool Write(const Frame& frame, const std::string& path, const HdrFrame* hdrFrame = nullptr);
+
+		//! WriteFloat
+		//! Writes linear RGB float pixels, rows top to bottom, to the given path as PFM
+		//! Returns false on failure
+		//!
+		bool WriteFloat(const float* rgb, int width, int height, const std::string& path);
+
+	}; // namespace FrameWriter
+
+}; // namespace Renderer
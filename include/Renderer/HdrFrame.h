@@ -0,0 +1,53 @@
+//!
+//! HdrFrame.h
+//! Defines a linear float frame buffer for accumulating radiance
+//!
+#pragma once
+
+#include <string>
+#include "AlignedAllocator.h"
+#include "Util.h"
+
+
+
+namespace Renderer {
+
+	//! HdrFrame
+	//! Linear RGB radiance with 1 as display white and no upper bound. Channels are stored in separate
+	//! planes so that consecutive pixels of a channel load as one vector. Rows are padded to whole cache
+	//! lines like those of Frame
+	//!
+	class HdrFrame {
+	public:
+		enum Channel { RED, GREEN, BLUE, CHANNEL_COUNT };
+		static constexpr int rowAlignment = (int)(Util::cacheLineSize / sizeof(float));	// Samples per cache line
+
+	private:
+		std::string name;
+		int width;
+		int height;
+		int pitch;		// Samples from the start of one row to the start of the next
+		Util::AlignedVector<float, Util::cacheLineSize> planes;	// Red, green, then blue plane, each row-major
+
+	public:
+		HdrFrame(std::string name, int width, int height);
+
+		std::string GetName() const;
+		int GetWidth() const;
+		int GetHeight() const;
+		int GetPitch() const;
+		float* GetPlane(Channel channel);
+		const float* GetPlane(Channel channel) const;
+
+		//! Unchecked access to the samples of a row of a channel
+		float* GetRow(Channel channel, int y) { return planes.data() + ((size_t)channel * height + y) * pitch; }
+		const float* GetRow(Channel channel, int y) const { return planes.data() + ((size_t)channel * height + y) * pitch; }
+
+		void SetPixel(int x, int y, float r, float g, float b);
+		void AddPixel(int x, int y, float r, float g, float b);
+		void Clear();
+		void CopyRect(const HdrFrame& source, int x, int y, int rectWidth, int rectHeight);
+		void FillRect(int x, int y, int rectWidth, int rectHeight, float r, float g, float b);
+	};
+
+}; // namespace Renderer
@@ -4,6 +4,8 @@
 //! 
 #pragma once
 
+#include <optional>
+#include <vector>
 #include "Util.h"
 #include "World.h"
 #include "Object.h"
@@ -14,34 +16,54 @@ namespace Renderer {
 
 	namespace RayMgr {
 
+		//! Pipeline types are templated on the scalar type T (float or double)
+		//! 
+		template <typename T>
 		struct Ray {
-			Util::Vector3<double> origin;
-			Util::Vector3<double> direction;
+			Util::Vector3<T> origin;
+			Util::Vector3<T> direction;
 		};
 
+		template <typename T>
+		struct DiffuseRay {
+			Ray<T> ray;
+			T lightDistance;	// Distance from the ray origin to the light
+		};
+
+		//! CollisionInfo
+		//! Hit record returned by value. Only the entry collision is resolved; the exit collision
+		//! is derived on demand through GetExitCollision
+		//! 
+		template <typename T>
 		struct CollisionInfo {
 			//! Primary collision
 			World::Object* object;
+			int faceIdx;	// Triangle hit within a mesh, -1 for other primitives
 
 			//! Object entry collision
-			Util::Vector3<double> position;
-			Util::Vector3<double> normal;
-			double distance;
+			Util::Vector3<T> position;
+			Util::Vector3<T> normal;
+			T distance;
 
-			//! Object exit collision
-			Util::Vector3<double> exitPosition;
-			Util::Vector3<double> exitNormal;
-			double exitDistance;
+			CollisionInfo() : object(nullptr), faceIdx(-1), position(), normal(), distance(0) {}
+		};
 
-			CollisionInfo() : object(nullptr), position(), normal(), distance(0), exitPosition(), exitDistance(0) {}
+		template <typename T>
+		struct ExitCollision {
+			Util::Vector3<T> position;
+			Util::Vector3<T> normal;
 		};
 
-		std::unique_ptr<CollisionInfo> GetFirstCollision(World::World& world, const Ray& ray);
-		std::unique_ptr<CollisionInfo> GetInternalCollision(World::Object& object, const Ray& ray);
+		//! Defined for float and double; world queries run at the precision of the world primitive storage
+		template <typename T> std::optional<CollisionInfo<T>> GetFirstCollision(World::World& world, const Ray<T>& ray);
+		template <typename T> void GetFirstCollisions(World::World& world, const Ray<T>* rays, int count, std::optional<CollisionInfo<T>>* collisions);
+		template <typename T> std::optional<CollisionInfo<T>> GetInternalCollision(World::Object& object, const Ray<T>& ray);
+		template <typename T> ExitCollision<T> GetExitCollision(const Ray<T>& ray, const CollisionInfo<T>& colInfo);
+		template <typename T> bool IsOccluded(World::World& world, const Ray<T>& ray, T tMax);
 
-		std::vector<RayMgr::Ray> GetDiffuseRays(const RayMgr::CollisionInfo* colInfo);
-		RayMgr::Ray GetReflectionRay(const RayMgr::Ray& ray, const RayMgr::CollisionInfo* colInfo);
-		RayMgr::Ray GetRefractionRay(const RayMgr::Ray& ray, const RayMgr::CollisionInfo* colInfo);
+		template <typename T> void GetDiffuseRays(const CollisionInfo<T>* colInfo, std::vector<DiffuseRay<T>>& rays);
+		template <typename T> Ray<T> GetReflectionRay(const Ray<T>& ray, const CollisionInfo<T>* colInfo);
+		template <typename T> Ray<T> GetRefractionRay(const Ray<T>& ray, const CollisionInfo<T>* colInfo);
 
 	}; // namespace RayMgr
 
@@ -4,11 +4,19 @@
 //! 
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <queue>
 #include <vector>
+#include "Accumulator.h"
 #include "Frame.h"
+#include "HdrFrame.h"
+#include "Tonemapper.h"
 #include "DisplayDriver.h"
 #include "RayMgr.h"
+#include "Wavefront.h"
+#include "TileGrid.h"
+#include "TileScheduler.h"
 #include "Player.h"
 #include "Util.h"
 #include "World.h"
@@ -17,44 +25,121 @@
 
 namespace Renderer {
 
+	//! CameraSnapshot
+	//! Camera basis captured when a frame is submitted, so the camera may move while the frame renders
+	//! 
+	struct CameraSnapshot {
+		Util::Vector3<Util::Real> position;
+		Util::Vector3<Util::Real> forward, right, up;
+		Util::Real halfWidth, halfHeight;	// Half extent of the image plane at unit distance
+		int frameWidth, frameHeight;
+		Util::Real jitterX = Util::Real(0.5), jitterY = Util::Real(0.5);	// Position within each pixel that rays pass through
+	};
+
 	class Renderer {
 	private:
 		//std::queue<std::pair<Util::Vector2<double>, Frame*>> renderQueue; // TODO: This should be a processing queue for calling functions, not creating a frame to apply
-		Frame window;
+		std::vector<std::unique_ptr<Frame>> frames;	// Ring of render frames; one renders while another is presented
+		std::vector<std::unique_ptr<HdrFrame>> hdrFrames;	// Linear radiance of each frame of the ring, tonemapped into it per tile
+		std::unique_ptr<Frame> outputFrame;		// Window sized upscale of a frame rendered below the window size
+		std::vector<bool> isFramePacked;		// Whether each frame of the ring holds its tonemapped pixels
+		std::vector<bool> isFrameInTexture;		// Whether each frame of the ring was tonemapped into its display texture instead
+		PixelView renderTarget;		// Pixels the tiles of the frame being rendered are tonemapped into
+		PixelView outputTarget;		// Pixels PrepareOutput upscales into
+		bool isOutputInTexture = false;	// Whether outputTarget is the locked display texture of the presented frame
+		TileGrid tileGrid;
+		TileScheduler tileScheduler;	// Orders and groups the tiles of each frame by their cost in the last frames
+		Tonemapper tonemapper;
+		Accumulator accumulator;		// Mean radiance of the frames rendered since the view last changed
+		CameraSnapshot frameCamera;		// Camera of the frame being rendered
+		std::chrono::steady_clock::time_point frameDeadline = std::chrono::steady_clock::time_point::max();	// Tiles not started by then fall back to the previous frame
+		std::atomic<int> nFallbackTiles = { 0 };	// Tiles of the frame being rendered that missed the deadline
 		DisplayDriver display;
 		std::shared_ptr<World::World> world;
 		std::shared_ptr<InputMgr::InputMgr> inputMgr;
 
 		//! Internal variables
 		bool isInitialized = false;
+		bool isHeadless;			// Frames are only rendered into memory; no window or SDL
+		int renderFrameIdx = 0;		// Frame being rendered
+		int presentFrameIdx = 0;	// Most recently completed frame
+		int windowWidth;
+		int windowHeight;
+		double renderScale = 1;		// Render resolution as a fraction of the window size per axis
+		bool isProgressive = false;	// Average frames of an unchanged view into an anti-aliased image
+		uint64_t accumulatedWorldVersion = 0;	// World version the accumulated frames were rendered with
 
 		//! Properties
 		const int maxRayDepth = 1;	// TODO: Configurable
+		const bool usePacketTracing = true;	// Intersect primary rays in coherent packets
+		const int maxWavefrontSize = 1024;	// Paths in flight per wavefront; bounds the cache footprint of the queues
+		const bool useRaySorting = false;		// Sort secondary rays by direction octant and origin before tracing
+		const bool useMaterialBinning = true;	// Shade collisions grouped by material
+		const bool useZeroCopyPresent = true;	// Write frames straight into locked display textures instead of copying them there
+		static constexpr int frameBufferCount = 2;	// Frames in the ring
+		static constexpr int defaultTileSize = 16;	// Tile edge in pixels; a multiple of 4 keeps packets square
+		static constexpr int maxTileSize = 256;		// Largest tile edge; bounds the per-tile pixel order
+		static constexpr uint32_t fallbackColor = 0x000000FF;	// Fills tiles that miss the deadline with no previous frame to show
+		static constexpr Util::Real radianceScale = Util::Real(1) / 255;	// Shading sums colors on a 0-255 scale; HDR frames hold white as 1
 
 	public:
 		//! Constructors
-		Renderer(const char* windowTitle, int windowWidth, int windowHeight, std::shared_ptr<Player::Player> player, std::shared_ptr<World::World> world, std::shared_ptr<InputMgr::InputMgr> inputMgr);
+		Renderer(const char* windowTitle, int windowWidth, int windowHeight, std::shared_ptr<Player::Player> player, std::shared_ptr<World::World> world, std::shared_ptr<InputMgr::InputMgr> inputMgr, bool isHeadless = false);
 
 		//! Initialization
 		bool Init();
 
 		//! Accessors
 		bool IsActive() const;	
+		bool IsHeadless() const;
 
 		//! Interface functions
 		void ProduceWorldFrame(std::shared_ptr<Player::Player> player);
+		void BeginFrame(const Player::Camera* camera, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+		void EndFrame();
 		void DisplayFrame();
-		std::vector<RayMgr::Ray> GenerateRays(const Player::Camera* camera, int frameWidth, int frameHeight);
-		Util::Vector3<double> CalcTotalLight(const RayMgr::Ray& ray) const;
+		void BeginOutput();
+		void PrepareOutput(int rowBegin, int rowEnd);
+		void PresentFrame();
+		void RenderTile(const Tile& tile);
+		void RenderTileBatch(int batchIdx);
+		Util::Vector3<Util::Real> CalcTotalLight(const RayMgr::Ray<Util::Real>& ray) const;
+		void CalcTotalLight(const RayMgr::Ray<Util::Real>* rays, int count, Util::Vector3<Util::Real>* colors) const;
 		Frame* GetRawFrame();
+		HdrFrame* GetRawHdrFrame();
 
 		//! Accessors
 		int GetWindowWidth() const;
 		int GetWindowHeight() const;
+		int GetRenderWidth() const;
+		int GetRenderHeight() const;
+		double GetRenderScale() const;
+		void SetRenderScale(double scale);
+		const std::vector<Tile>& GetTiles() const;
+		const std::vector<TileBatch>& GetTileBatches() const;
+		int GetTileSize() const;
+		void SetTileSize(int tileSize);
+		void SetTileOrder(TileOrder order);
+		int GetFallbackTileCount() const;
+		const TonemapSettings& GetTonemapSettings() const;
+		void SetTonemapSettings(const TonemapSettings& settings);
+		bool IsProgressive() const;
+		void SetProgressive(bool isProgressive);
+		int GetAccumulatedFrameCount() const;
 
 	private:
 		//! Helper functions
-		Util::Vector3<double> _CalcTotalLightHelper(const RayMgr::Ray& ray, int depth) const;
+		void _SortPaths(Wavefront& wavefront) const;
+		void _IntersectPaths(Wavefront& wavefront, int depth) const;
+		void _BinCollisions(Wavefront& wavefront) const;
+		void _ShadePaths(Wavefront& wavefront, int depth) const;
+		void _TraceShadows(Wavefront& wavefront, Util::Vector3<Util::Real>* colors) const;
+		void _StoreRadiance(int px, int py, const Util::Vector3<Util::Real>& color);
+		void _FillFallbackTile(const Tile& tile);
+		bool _CanPresentZeroCopy() const;
+		static CameraSnapshot _SnapshotCamera(const Player::Camera* camera, int frameWidth, int frameHeight);
+		static bool _IsSameView(const CameraSnapshot& a, const CameraSnapshot& b);
+		static RayMgr::Ray<Util::Real> _GenerateRay(const CameraSnapshot& snapshot, int px, int py);
 	};
 
 }; // namespace Renderer
\ No newline at end of file
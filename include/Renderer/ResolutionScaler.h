@@ -0,0 +1,43 @@
+//!
+//! ResolutionScaler.h
+//! Frame time driven control of the internal render resolution
+//! 
+#pragma once
+
+
+
+namespace Renderer {
+
+	//! ResolutionScaler
+	//! Tracks a smoothed frame time and picks a render scale, as a fraction of the window size per axis,
+	//! that keeps frames within the budget. Rendering cost is taken as proportional to the pixel count.
+	//! The scale drops as soon as frames run over budget and only recovers once there is clear headroom
+	//! 
+	class ResolutionScaler {
+	private:
+		double frameTimeBudget;		// Seconds; 0 disables scaling
+		double minScale;
+		double scale = 1;
+		double smoothedFrameTime = 0;
+
+		//! Properties
+		static constexpr double smoothing = 0.25;		// Weight of the newest frame in the average
+		static constexpr double targetLoad = 0.9;		// Fraction of the budget aimed for when rescaling
+		static constexpr double headroomLoad = 0.75;	// Load below which the scale may increase
+		static constexpr double maxStep = 0.15;			// Largest relative scale change per frame
+		static constexpr double scaleQuantum = 1.0 / 32;	// Scales snap to multiples of this, avoiding constant reallocation
+
+	public:
+		//! Constructors
+		ResolutionScaler(double frameTimeBudget = 0, double minScale = 0.5);
+
+		//! Interface functions
+		void AddFrameTime(double seconds);
+		void SetFrameTimeBudget(double seconds);
+
+		//! Accessors
+		double GetScale() const { return scale; }
+		bool IsEnabled() const { return frameTimeBudget > 0; }
+	};
+
+}; // namespace Renderer
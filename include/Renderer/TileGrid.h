@@ -0,0 +1,55 @@
+//!
+//! TileGrid.h
+//! Decomposition of a frame into square tiles of pixels
+//! 
+#pragma once
+
+#include <vector>
+#include "Util.h"
+
+
+
+namespace Renderer {
+
+	//! Tile
+	//! Rectangular block of pixels rendered as one unit of work. Tiles on the right and bottom
+	//! edges of the frame are clipped to it
+	//! 
+	struct Tile {
+		int x, y;
+		int width, height;
+	};
+
+	//! TileGrid
+	//! Covers a frame with square tiles issued in Morton order of their grid position, so that
+	//! consecutive tiles are spatial neighbours. Pixels within a tile are also visited in Morton
+	//! order, keeping every run of 4^k rays a square block of the image
+	//! 
+	class TileGrid {
+	public:
+		//! Pixel offset within a tile
+		struct Offset {
+			uint16_t x, y;
+		};
+
+	private:
+		int frameWidth = 0;
+		int frameHeight = 0;
+		int tileSize = 0;
+
+		std::vector<Tile> tiles;			// Morton order
+		std::vector<Offset> pixelOrder;		// Offsets of a full tile in Morton order
+
+	public:
+		//! Interface functions
+		void Build(int frameWidth, int frameHeight, int tileSize);
+
+		//! Accessors
+		int GetTileSize() const { return tileSize; }
+		int GetFrameWidth() const { return frameWidth; }
+		int GetFrameHeight() const { return frameHeight; }
+		const std::vector<Tile>& GetTiles() const { return tiles; }
+		const std::vector<Offset>& GetPixelOrder() const { return pixelOrder; }
+	};
+
+}; // namespace Renderer
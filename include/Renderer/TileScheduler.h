@@ -0,0 +1,91 @@
+//!
+//! TileScheduler.h
+//! Cost-aware ordering and grouping of render tiles
+//! 
+#pragma once
+
+#include <vector>
+#include "Frame.h"
+#include "TileGrid.h"
+
+
+
+namespace Renderer {
+
+	//! TileBatch
+	//! Consecutive run of scheduled tiles rendered as one unit of work
+	//! 
+	struct TileBatch {
+		int firstTile;
+		int tileCount;
+	};
+
+	//! TileOrder
+	//! Order batches are issued in
+	//! 
+	enum class TileOrder {
+		COST,			// Most expensive first; minimizes the time to finish the frame
+		CENTER_FIRST	// Nearest to the frame center first; the center is done first when a frame runs out of time
+	};
+
+	//! TileScheduler
+	//! Plans the work of a frame from the tile render times of the previous frames. Each cell of the tile
+	//! grid keeps a smoothed cost; cells far above the mean are split into quadrants, runs of cells far below
+	//! it are merged into one batch, and batches are issued most expensive first so the costly work starts
+	//! early and cheap batches fill in the tail. Without timings the grid is issued in Morton order.
+	//! Batches may instead be issued center first, for frames that are cut off at a deadline
+	//! 
+	class TileScheduler {
+	private:
+		struct WorkItem {
+			double cost;
+			int firstTile;
+			int tileCount;
+		};
+
+		std::vector<Tile> tiles;			// Schedule order; the tiles of a batch are adjacent
+		std::vector<int> tileCells;			// Grid cell each scheduled tile belongs to
+		std::vector<TileBatch> batches;		// Schedule order
+		std::vector<double> tileTimes;		// Seconds measured this frame per scheduled tile; negative if not rendered
+		std::vector<double> cellCosts;		// Smoothed seconds per grid cell
+
+		//! Scratch space reused between frames
+		std::vector<Tile> scratchTiles;
+		std::vector<int> scratchCells;
+		std::vector<WorkItem> workItems;
+
+		TileOrder order = TileOrder::COST;
+
+		//! Properties
+		static constexpr double costSmoothing = 0.5;	// Weight of the newest frame in the cell costs
+		static constexpr double splitFactor = 3.0;		// Cells costing more than this times the mean are split
+		static constexpr double mergeFactor = 0.25;		// Cells costing less than this times the mean are merged
+		static constexpr int minSplitSize = 8;			// Smallest tile height that is split; keeps quadrants a multiple of 4
+		static constexpr int columnAlignment = Frame::rowAlignment;	// Columns parts are split at; keeps parts on separate cache lines
+
+	public:
+		//! Interface functions
+		void Reset(const TileGrid& grid);
+		void Update(const TileGrid& grid);
+		void SetOrder(TileOrder order, const TileGrid& grid);
+
+		//! Records the render time of the given scheduled tile. Each tile is recorded by one thread only
+		void RecordTime(int tileIdx, double seconds) { tileTimes[tileIdx] = seconds; }
+
+		//! Records that the given scheduled tile was not rendered, so its cell keeps its previous cost
+		void RecordSkipped(int tileIdx) { tileTimes[tileIdx] = -1; }
+
+		//! Accessors
+		const std::vector<Tile>& GetTiles() const { return tiles; }
+		const std::vector<TileBatch>& GetBatches() const { return batches; }
+		TileOrder GetOrder() const { return order; }
+
+	private:
+		//! Helper functions
+		void _AddItem(double cost, const Tile& tile, int cellIdx);
+		void _SplitTile(const Tile& tile, int cellIdx, double cost);
+		void _SortItems(const TileGrid& grid);
+		void _EmitItems();
+	};
+
+}; // namespace Renderer
@@ -0,0 +1,49 @@
+//!
+//! Tonemapper.h
+//! Converts linear radiance to packed display pixels
+//!
+#pragma once
+
+#include <cstdint>
+#include "Frame.h"
+#include "HdrFrame.h"
+
+
+
+namespace Renderer {
+
+	enum class TonemapOperator {
+		CLAMP,			// Radiance above white clips
+		REINHARD		// Extended Reinhard; radiance compresses smoothly up to the white point
+	};
+
+	//! TonemapSettings
+	//! The defaults show radiance unchanged up to white, as scene colors are authored for display
+	//!
+	struct TonemapSettings {
+		TonemapOperator op = TonemapOperator::CLAMP;
+		float exposure = 1;			// Linear scale applied before the operator
+		float whitePoint = 4;		// Radiance mapped to white by REINHARD
+		bool encodeGamma = false;	// Encode for display with gamma 2, an approximation of sRGB
+	};
+
+	//! Tonemapper
+	//! Maps rectangles of an HDR frame to SDL_PIXELFORMAT_RGBA8888 pixels, eight pixels at a time with AVX2. The
+	//! target may be a frame or a locked display texture
+	//! Channels are clamped before packing, so bright radiance saturates instead of spilling into the next channel
+	//!
+	class Tonemapper {
+	private:
+		TonemapSettings settings;
+
+	public:
+		const TonemapSettings& GetSettings() const;
+		void SetSettings(const TonemapSettings& settings);
+
+		void Apply(const HdrFrame& source, const PixelView& target, int x, int y, int width, int height) const;
+
+	private:
+		void _MapRow(const float* r, const float* g, const float* b, uint32_t* dst, int count) const;
+	};
+
+}; // namespace Renderer
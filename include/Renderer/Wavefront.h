@@ -0,0 +1,75 @@
+//!
+//! Wavefront.h
+//! Queues of ray work processed one bounce at a time by the renderer
+//! 
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "RayMgr.h"
+
+
+
+namespace Renderer {
+
+	//! PathQueue
+	//! Structure-of-arrays queue of path segments traced together in one bounce
+	//! 
+	struct PathQueue {
+		std::vector<RayMgr::Ray<Util::Real>> rays;
+		std::vector<Util::Vector3<Util::Real>> throughput;	// Weight of the light arriving along the ray in the final color
+		std::vector<int> colorIdx;							// Output color the path contributes to
+
+		int GetCount() const { return (int)rays.size(); }
+
+		void Clear() {
+			rays.clear();
+			throughput.clear();
+			colorIdx.clear();
+		}
+
+		void Push(const RayMgr::Ray<Util::Real>& ray, const Util::Vector3<Util::Real>& weight, int colorIdx) {
+			rays.push_back(ray);
+			throughput.push_back(weight);
+			this->colorIdx.push_back(colorIdx);
+		}
+	};
+
+	//! ShadowQueue
+	//! Rays towards lights whose contribution is added if the light is unoccluded
+	//! 
+	struct ShadowQueue {
+		std::vector<RayMgr::DiffuseRay<Util::Real>> rays;
+		std::vector<Util::Vector3<Util::Real>> contribution;	// Weighted light added on reaching the light
+		std::vector<int> colorIdx;
+
+		int GetCount() const { return (int)rays.size(); }
+
+		void Clear() {
+			rays.clear();
+			contribution.clear();
+			colorIdx.clear();
+		}
+	};
+
+	//! Wavefront
+	//! Per-thread working set reused across bounces and calls, so that tracing does not allocate in steady state
+	//! 
+	struct Wavefront {
+		PathQueue paths;		// Current bounce
+		PathQueue nextPaths;	// Spawned for the next bounce
+		ShadowQueue shadows;
+		std::vector<std::optional<RayMgr::CollisionInfo<Util::Real>>> collisions;	// Parallel to paths
+
+		//! Coherence stages
+		PathQueue sortedPaths;								// Scratch target of path sorting
+		std::vector<std::pair<uint32_t, int>> sortKeys;		// Octant and origin cell key per path
+		std::vector<std::pair<uint32_t, int>> sortScratch;
+		std::vector<int> sortCounts;
+		std::vector<int> shadeOrder;						// Indices of the paths with a collision, in shading order
+		std::vector<int> binStarts;							// Start of each material bin in shadeOrder
+	};
+
+}; // namespace Renderer
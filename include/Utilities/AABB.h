@@ -0,0 +1,83 @@
+//!
+//! AABB.h
+//! Axis-aligned bounding box
+//!
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace Util {
+
+	template <typename T>
+	struct AABB {
+		Vector3<T> min;
+		Vector3<T> max;
+
+		//! Constructors
+		//! Default box is empty (inverted) so that any growth produces a valid box
+		AABB() : min(INFINITY, INFINITY, INFINITY), max(-INFINITY, -INFINITY, -INFINITY) {}
+		AABB(const Vector3<T>& min, const Vector3<T>& max) : min(min), max(max) {}
+
+		//! Utility functions
+		void Grow(const Vector3<T>& point) {
+			min = Vector3<T>(std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z));
+			max = Vector3<T>(std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z));
+		}
+
+		void Grow(const AABB& other) {
+			Grow(other.min);
+			Grow(other.max);
+		}
+
+		bool IsValid() const {
+			return min.x <= max.x && min.y <= max.y && min.z <= max.z;
+		}
+
+		Vector3<T> Centroid() const {
+			return (min + max) * T(0.5);
+		}
+
+		Vector3<T> Extent() const {
+			return max - min;
+		}
+
+		T SurfaceArea() const {
+			if (!IsValid()) {
+				return 0;
+			}
+
+			Vector3<T> e = Extent();
+			return 2 * (e.x * e.y + e.y * e.z + e.z * e.x);
+		}
+
+		//! IntersectRay
+		//! Slab test against the box. Returns the entry distance, or INFINITY on a miss
+		//! invDir is the per-component reciprocal of the ray direction
+		//!
+		T IntersectRay(const Vector3<T>& origin, const Vector3<T>& invDir, T tMax) const {
+			T tx1 = (min.x - origin.x) * invDir.x;
+			T tx2 = (max.x - origin.x) * invDir.x;
+			T tNear = std::min(tx1, tx2);
+			T tFar = std::max(tx1, tx2);
+
+			T ty1 = (min.y - origin.y) * invDir.y;
+			T ty2 = (max.y - origin.y) * invDir.y;
+			tNear = std::max(tNear, std::min(ty1, ty2));
+			tFar = std::min(tFar, std::max(ty1, ty2));
+
+			T tz1 = (min.z - origin.z) * invDir.z;
+			T tz2 = (max.z - origin.z) * invDir.z;
+			tNear = std::max(tNear, std::min(tz1, tz2));
+			tFar = std::min(tFar, std::max(tz1, tz2));
+
+			if (tFar >= tNear && tFar > 0 && tNear < tMax) {
+				return tNear;
+			}
+			return INFINITY;
+		}
+	};
+
+}; // namespace Util
@@ -0,0 +1,50 @@
+//!
+//! AlignedAllocator.h
+//! Standard allocator returning memory aligned to a fixed boundary
+//!
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+
+
+namespace Util {
+
+	constexpr std::size_t cacheLineSize = 64;
+
+	template <typename T, std::size_t Alignment>
+	class AlignedAllocator {
+		static_assert(Alignment >= alignof(T), "Alignment must satisfy the natural alignment of T");
+		static_assert((Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+	public:
+		using value_type = T;
+
+		template <typename U>
+		struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+		AlignedAllocator() noexcept {}
+		template <typename U>
+		AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+		T* allocate(std::size_t n) {
+			return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+		}
+
+		void deallocate(T* ptr, std::size_t) noexcept {
+			::operator delete(ptr, std::align_val_t(Alignment));
+		}
+
+		template <typename U>
+		bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+		template <typename U>
+		bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+	};
+
+	//! Vector with storage aligned for SIMD loads
+	template <typename T, std::size_t Alignment = 32>
+	using AlignedVector = std::vector<T, AlignedAllocator<T, Alignment>>;
+
+}; // namespace Util
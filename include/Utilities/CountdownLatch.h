@@ -0,0 +1,41 @@
+//!
+//! CountdownLatch.h
+//! Reusable completion counter that threads can block on
+//! 
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+
+
+namespace Util {
+
+	//! CountdownLatch
+	//! Counts outstanding work down to zero without locking except for the final count, which
+	//! wakes the waiters. The latch may be destroyed as soon as Wait returns
+	//! 
+	class CountdownLatch {
+	private:
+		std::atomic<int> count;
+		std::mutex mutex;
+		std::condition_variable cond;
+
+	public:
+		//! Constructors
+		explicit CountdownLatch(int count = 0);
+		CountdownLatch(const CountdownLatch&) = delete;
+		CountdownLatch& operator=(const CountdownLatch&) = delete;
+
+		//! Interface functions
+		void Reset(int count);
+		void Add(int n = 1);
+		void CountDown(int n = 1);
+		void Wait();
+
+		//! Accessors
+		bool IsDone() const;
+	};
+
+}; // namespace Util
@@ -0,0 +1,41 @@
+//!
+//! CpuTopology.h
+//! Logical processor layout used to place worker threads
+//! 
+#pragma once
+
+#include <vector>
+
+
+
+namespace Util {
+
+	//! CpuTopology
+	//! Logical processors available to the process, with the physical core, package and NUMA node of each
+	//! Platforms without topology information report every processor as its own core on node 0
+	//! 
+	class CpuTopology {
+	public:
+		struct Processor {
+			int cpu;		// OS index, as used for affinity
+			int core;		// Physical core, unique across packages
+			int package;
+			int node;		// NUMA node
+			int smtRank;	// Index among the hardware threads of its core
+		};
+
+	private:
+		std::vector<Processor> processors;
+		int nodeCount = 1;
+
+	public:
+		//! Interface functions
+		static CpuTopology Detect();
+		std::vector<Processor> GetPlacementOrder() const;
+
+		//! Accessors
+		const std::vector<Processor>& GetProcessors() const { return processors; }
+		int GetNodeCount() const { return nodeCount; }
+	};
+
+}; // namespace Util
@@ -9,29 +9,59 @@
 
 
 
-namespace Util {
+//! Lowest priority level compiled in: 1 error, 2 warning, 3 debug, 4 info
+#ifndef RAYTRACER_LOG_LEVEL
+#define RAYTRACER_LOG_LEVEL 2
+#endif
 
-	class Log {
-	private:
-		enum class LOG_LEVEL {
-			ERROR = 1,
-			WARNING = 2,
-			DEBUG = 3,
-			INFO = 4
-		};
+//! Logging macros
+//! Calls below RAYTRACER_LOG_LEVEL are removed entirely, including the formatting of their message,
+//! so messages are only built when they can be emitted. Removed calls keep their message as an
+//! unevaluated sizeof operand, so variables that only feed a log message are still used
+//! 
+#if RAYTRACER_LOG_LEVEL >= 1
+#define LOG_ERROR(message) Util::Log::Error(message)
+#else
+#define LOG_ERROR(message) ((void)sizeof(message))
+#endif
+
+#if RAYTRACER_LOG_LEVEL >= 2
+#define LOG_WARN(message) Util::Log::Warn(message)
+#else
+#define LOG_WARN(message) ((void)sizeof(message))
+#endif
+
+#if RAYTRACER_LOG_LEVEL >= 3
+#define LOG_DEBUG(message) Util::Log::Debug(message)
+#else
+#define LOG_DEBUG(message) ((void)sizeof(message))
+#endif
 
-		static std::mutex mutex;
-		static constexpr LOG_LEVEL logLevel = LOG_LEVEL::WARNING;
+#if RAYTRACER_LOG_LEVEL >= 4
+#define LOG_INFO(message) Util::Log::Info(message)
+#else
+#define LOG_INFO(message) ((void)sizeof(message))
+#endif
 
+
+
+namespace Util {
+
+	//! Log
+	//! Messages are queued on a lock-free ring and written to the console by a background thread, so
+	//! logging never blocks on the console. Prefer the LOG_* macros, which strip disabled levels
+	//! 
+	class Log {
 	public:
 		Log() = delete;
 		Log(const Log&) = delete;
 		Log& operator=(const Log&) = delete;
 
-		static void Info(std::string message);
-		static void Debug(std::string message);
-		static void Warn(std::string message);
-		static void Error(std::string message);
+		static void Info(const std::string& message);
+		static void Debug(const std::string& message);
+		static void Warn(const std::string& message);
+		static void Error(const std::string& message);
+		static void Flush();
 	};
 
 }; // namespace Util
\ No newline at end of file
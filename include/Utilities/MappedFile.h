@@ -0,0 +1,43 @@
+//!
+//! MappedFile.h
+//! Read-only memory mapping of a file
+//! 
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+
+
+namespace Util {
+
+	class MappedFile {
+	private:
+		const char* data = nullptr;
+		std::size_t size = 0;
+
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#else
+		int fileDescriptor = -1;
+#endif
+
+	public:
+		//! Constructors
+		MappedFile() = default;
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		//! Interface functions
+		bool Open(const std::string& path);
+		void Close();
+
+		//! Accessors
+		bool IsOpen() const;
+		const char* GetData() const;
+		std::size_t GetSize() const;
+	};
+
+}; // namespace Util
@@ -0,0 +1,51 @@
+//!
+//! Morton.h
+//! Z-order curve encoding for ordering spatially coherent work
+//! 
+#pragma once
+
+#include <cstdint>
+
+
+
+namespace Util {
+
+	//! _SpreadBits3
+	//! Spreads the low 10 bits of v so that two zero bits follow each bit
+	//! 
+	inline uint32_t _SpreadBits3(uint32_t v) {
+		v &= 0x3FF;
+		v = (v | (v << 16)) & 0x030000FF;
+		v = (v | (v << 8)) & 0x0300F00F;
+		v = (v | (v << 4)) & 0x030C30C3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	//! MortonEncode3
+	//! Interleaves three 10-bit coordinates into a 30-bit Morton code
+	//! 
+	inline uint32_t MortonEncode3(uint32_t x, uint32_t y, uint32_t z) {
+		return _SpreadBits3(x) | (_SpreadBits3(y) << 1) | (_SpreadBits3(z) << 2);
+	}
+
+	//! _SpreadBits2
+	//! Spreads the low 16 bits of v so that a zero bit follows each bit
+	//! 
+	inline uint32_t _SpreadBits2(uint32_t v) {
+		v &= 0xFFFF;
+		v = (v | (v << 8)) & 0x00FF00FF;
+		v = (v | (v << 4)) & 0x0F0F0F0F;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	}
+
+	//! MortonEncode2
+	//! Interleaves two 16-bit coordinates into a 32-bit Morton code
+	//! 
+	inline uint32_t MortonEncode2(uint32_t x, uint32_t y) {
+		return _SpreadBits2(x) | (_SpreadBits2(y) << 1);
+	}
+
+}; // namespace Util
@@ -0,0 +1,57 @@
+//!
+//! RayPacket.h
+//! Structure-of-arrays bundle of coherent rays traced together
+//!
+#pragma once
+
+#include <cmath>
+#include "Real.h"
+
+
+
+namespace Util {
+
+	struct RayPacket {
+		static constexpr int maxSize = 16;	// 4x4 pixels
+
+		alignas(32) Real originX[maxSize];
+		alignas(32) Real originY[maxSize];
+		alignas(32) Real originZ[maxSize];
+		alignas(32) Real dirX[maxSize];
+		alignas(32) Real dirY[maxSize];
+		alignas(32) Real dirZ[maxSize];
+		alignas(32) Real tMax[maxSize];	// Nearest collision distance found so far per ray
+		int count;
+
+		RayPacket() : count(0) {}
+
+		//! Set
+		//! Stores a ray at the given slot, resetting its search distance
+		//!
+		void Set(int rayIdx, const Vector3<Real>& origin, const Vector3<Real>& direction) {
+			originX[rayIdx] = origin.x;
+			originY[rayIdx] = origin.y;
+			originZ[rayIdx] = origin.z;
+			dirX[rayIdx] = direction.x;
+			dirY[rayIdx] = direction.y;
+			dirZ[rayIdx] = direction.z;
+			tMax[rayIdx] = INFINITY;
+		}
+
+		//! Pad
+		//! Fills unused slots up to a multiple of laneCount with rays that never collide
+		//!
+		void Pad(int laneCount) {
+			int paddedCount = ((count + laneCount - 1) / laneCount) * laneCount;
+			for (int rayIdx = count; rayIdx < paddedCount && rayIdx < maxSize; rayIdx++) {
+				originX[rayIdx] = originY[rayIdx] = originZ[rayIdx] = NAN;
+				dirX[rayIdx] = dirY[rayIdx] = dirZ[rayIdx] = NAN;
+				tMax[rayIdx] = -INFINITY;
+			}
+		}
+
+		Vector3<Real> GetOrigin(int rayIdx) const { return Vector3<Real>(originX[rayIdx], originY[rayIdx], originZ[rayIdx]); }
+		Vector3<Real> GetDirection(int rayIdx) const { return Vector3<Real>(dirX[rayIdx], dirY[rayIdx], dirZ[rayIdx]); }
+	};
+
+}; // namespace Util
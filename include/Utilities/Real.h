@@ -0,0 +1,27 @@
+//!
+//! Real.h
+//! Scalar type of the ray tracing pipeline
+//! 
+#pragma once
+
+
+
+namespace Util {
+
+	//! Real
+	//! Precision used for rays, collisions, shading, and acceleration structures
+	//! World object transforms remain double precision
+	//! 
+#ifdef RAYTRACER_SINGLE_PRECISION
+	using Real = float;
+#else
+	using Real = double;
+#endif
+
+	//! collisionEpsilon
+	//! Minimum collision distance along a ray, rejecting self-collisions at the ray origin
+	//! 
+	template <typename T> constexpr T collisionEpsilon = T(1e-9);
+	template <> constexpr float collisionEpsilon<float> = 1e-4f;
+
+}; // namespace Util
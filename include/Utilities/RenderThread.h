@@ -1,23 +1,21 @@
 //!
 //! RenderThread.h
-//! Defines an worker thread that processes rendering tasks
+//! Defines the worker thread of the rendering pool
 //! 
 #pragma once
 
 #include "WorkerThread.h"
-#include "RenderTask.h"
 
 
 
 namespace Util {
 
-	class RenderThread : public WorkerThread<RenderTask> {
+	class RenderThread : public WorkerThread {
 	public:
-		RenderThread(std::string name, std::function<void(WorkerThread*, bool)> taskComplete_Callback);
+		RenderThread(std::string name, RunLoopType runLoop);
 
 	protected:
 		bool Init() override;
-		bool HandleTask() override;
 	};
 
 }; // namespace Util
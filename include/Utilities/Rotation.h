@@ -4,6 +4,7 @@
 //! 
 #pragma once
 
+#include <cmath>
 #include <iostream>
 
 
@@ -13,6 +14,29 @@ namespace Util {
 	struct Rotation {
 		double yaw, pitch, roll;
 		Rotation(double yaw, double pitch, double roll) : yaw(yaw), pitch(pitch), roll(roll) {}
+
+		//! Rotate
+		//! Rotates the given vector by roll (about z), then pitch (about x), then yaw (about y)
+		//! Angles are in degrees
+		//! 
+		Vector3<double> Rotate(const Vector3<double>& vec) const {
+			double yawRad = yaw * PI / 180;
+			double pitchRad = pitch * PI / 180;
+			double rollRad = roll * PI / 180;
+
+			Vector3<double> rolled(
+				vec.x * std::cos(rollRad) - vec.y * std::sin(rollRad),
+				vec.x * std::sin(rollRad) + vec.y * std::cos(rollRad),
+				vec.z);
+			Vector3<double> pitched(
+				rolled.x,
+				rolled.y * std::cos(pitchRad) - rolled.z * std::sin(pitchRad),
+				rolled.y * std::sin(pitchRad) + rolled.z * std::cos(pitchRad));
+			return Vector3<double>(
+				pitched.x * std::cos(yawRad) + pitched.z * std::sin(yawRad),
+				pitched.y,
+				-pitched.x * std::sin(yawRad) + pitched.z * std::cos(yawRad));
+		}
 	};
 
 }; // namespace Util
\ No newline at end of file
@@ -0,0 +1,151 @@
+//!
+//! Simd.h
+//! Packed lanes of scalars for writing batched kernels once for every precision
+//!
+#pragma once
+
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+
+namespace Util {
+
+	//! Simd
+	//! Generic fallback holding a single lane; kernels written against it run as plain scalar code
+	//! Comparisons produce a Mask, whose Bits() has bit i set for each passing lane i
+	//!
+	template <typename T>
+	struct Simd {
+		static constexpr int width = 1;
+
+		struct Mask {
+			bool v;
+			Mask(bool v) : v(v) {}
+			int Bits() const { return v ? 1 : 0; }
+			friend Mask operator&(Mask a, Mask b) { return a.v && b.v; }
+			friend Mask operator|(Mask a, Mask b) { return a.v || b.v; }
+		};
+
+		T v;
+		Simd() : v(0) {}
+		Simd(T v) : v(v) {}
+
+		//! Memory operations
+		static Simd Load(const T* src) { return *src; }
+		static Simd LoadAligned(const T* src) { return *src; }
+		void Store(T* dst) const { *dst = v; }
+		void StoreAligned(T* dst) const { *dst = v; }
+
+		//! Mask of the lanes below count
+		static Mask FirstLanes(int count) { return count > 0; }
+
+		//! Operators
+		friend Simd operator+(Simd a, Simd b) { return a.v + b.v; }
+		friend Simd operator-(Simd a, Simd b) { return a.v - b.v; }
+		friend Simd operator*(Simd a, Simd b) { return a.v * b.v; }
+		friend Simd operator/(Simd a, Simd b) { return a.v / b.v; }
+		friend Mask operator<(Simd a, Simd b) { return a.v < b.v; }
+		friend Mask operator>(Simd a, Simd b) { return a.v > b.v; }
+		friend Mask operator>=(Simd a, Simd b) { return a.v >= b.v; }
+		friend Mask operator<=(Simd a, Simd b) { return a.v <= b.v; }
+
+		//! Utility functions
+		friend Simd Sqrt(Simd a) { return std::sqrt(a.v); }
+		friend Simd Min(Simd a, Simd b) { return (a.v < b.v) ? a : b; }
+		friend Simd Max(Simd a, Simd b) { return (a.v > b.v) ? a : b; }
+		friend Simd Select(Mask mask, Simd a, Simd b) { return mask.v ? a : b; }	// Per lane mask ? a : b
+	};
+
+#if defined(__AVX2__)
+	//! Four double lanes
+	//!
+	template <>
+	struct Simd<double> {
+		static constexpr int width = 4;
+
+		struct Mask {
+			__m256d v;
+			Mask(__m256d v) : v(v) {}
+			int Bits() const { return _mm256_movemask_pd(v); }
+			friend Mask operator&(Mask a, Mask b) { return _mm256_and_pd(a.v, b.v); }
+			friend Mask operator|(Mask a, Mask b) { return _mm256_or_pd(a.v, b.v); }
+		};
+
+		__m256d v;
+		Simd() : v(_mm256_setzero_pd()) {}
+		Simd(__m256d v) : v(v) {}
+		Simd(double s) : v(_mm256_set1_pd(s)) {}
+
+		static Simd Load(const double* src) { return _mm256_loadu_pd(src); }
+		static Simd LoadAligned(const double* src) { return _mm256_load_pd(src); }
+		void Store(double* dst) const { _mm256_storeu_pd(dst, v); }
+		void StoreAligned(double* dst) const { _mm256_store_pd(dst, v); }
+
+		static Mask FirstLanes(int count) {
+			return _mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_set1_epi64x(count), _mm256_set_epi64x(3, 2, 1, 0)));
+		}
+
+		friend Simd operator+(Simd a, Simd b) { return _mm256_add_pd(a.v, b.v); }
+		friend Simd operator-(Simd a, Simd b) { return _mm256_sub_pd(a.v, b.v); }
+		friend Simd operator*(Simd a, Simd b) { return _mm256_mul_pd(a.v, b.v); }
+		friend Simd operator/(Simd a, Simd b) { return _mm256_div_pd(a.v, b.v); }
+		friend Mask operator<(Simd a, Simd b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+		friend Mask operator>(Simd a, Simd b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+		friend Mask operator>=(Simd a, Simd b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GE_OQ); }
+		friend Mask operator<=(Simd a, Simd b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+
+		friend Simd Sqrt(Simd a) { return _mm256_sqrt_pd(a.v); }
+		friend Simd Min(Simd a, Simd b) { return _mm256_min_pd(a.v, b.v); }
+		friend Simd Max(Simd a, Simd b) { return _mm256_max_pd(a.v, b.v); }
+		friend Simd Select(Mask mask, Simd a, Simd b) { return _mm256_blendv_pd(b.v, a.v, mask.v); }
+	};
+
+	//! Eight float lanes
+	//!
+	template <>
+	struct Simd<float> {
+		static constexpr int width = 8;
+
+		struct Mask {
+			__m256 v;
+			Mask(__m256 v) : v(v) {}
+			int Bits() const { return _mm256_movemask_ps(v); }
+			friend Mask operator&(Mask a, Mask b) { return _mm256_and_ps(a.v, b.v); }
+			friend Mask operator|(Mask a, Mask b) { return _mm256_or_ps(a.v, b.v); }
+		};
+
+		__m256 v;
+		Simd() : v(_mm256_setzero_ps()) {}
+		Simd(__m256 v) : v(v) {}
+		Simd(float s) : v(_mm256_set1_ps(s)) {}
+
+		static Simd Load(const float* src) { return _mm256_loadu_ps(src); }
+		static Simd LoadAligned(const float* src) { return _mm256_load_ps(src); }
+		void Store(float* dst) const { _mm256_storeu_ps(dst, v); }
+		void StoreAligned(float* dst) const { _mm256_store_ps(dst, v); }
+
+		static Mask FirstLanes(int count) {
+			return _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(count), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0)));
+		}
+
+		friend Simd operator+(Simd a, Simd b) { return _mm256_add_ps(a.v, b.v); }
+		friend Simd operator-(Simd a, Simd b) { return _mm256_sub_ps(a.v, b.v); }
+		friend Simd operator*(Simd a, Simd b) { return _mm256_mul_ps(a.v, b.v); }
+		friend Simd operator/(Simd a, Simd b) { return _mm256_div_ps(a.v, b.v); }
+		friend Mask operator<(Simd a, Simd b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ); }
+		friend Mask operator>(Simd a, Simd b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ); }
+		friend Mask operator>=(Simd a, Simd b) { return _mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ); }
+		friend Mask operator<=(Simd a, Simd b) { return _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ); }
+
+		friend Simd Sqrt(Simd a) { return _mm256_sqrt_ps(a.v); }
+		friend Simd Min(Simd a, Simd b) { return _mm256_min_ps(a.v, b.v); }
+		friend Simd Max(Simd a, Simd b) { return _mm256_max_ps(a.v, b.v); }
+		friend Simd Select(Mask mask, Simd a, Simd b) { return _mm256_blendv_ps(b.v, a.v, mask.v); }
+	};
+#endif
+
+}; // namespace Util
@@ -0,0 +1,240 @@
+//!
+//! TaskGraph.h
+//! Dependency graph of work executed on a thread pool
+//! 
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include "Log.h"
+
+
+
+
+namespace Util {
+
+	//! TaskGraph
+	//! Nodes are index ranges processed by a function, like a parallel for, and edges order them. A node is
+	//! launched as soon as its last predecessor completes, so independent nodes overlap and there is no
+	//! barrier between stages. Nodes run on the pool unless marked to run on the thread calling Run, for
+	//! work that must stay on that thread. The graph may be rebuilt between runs without allocating once warm
+	//! 
+	template <class PoolType>
+	class TaskGraph {
+	public:
+		using RangeFunction = std::function<void(int begin, int end)>;
+
+	private:
+		//! Node
+		//! 
+		struct Node {
+			RangeFunction function;
+			int begin, end;
+			int grain;
+			bool runOnCaller;					// Runs on the thread calling Run, as a single chunk
+
+			std::atomic<int> nWaiting;			// Predecessors yet to complete
+			std::atomic<int> remaining;			// Unprocessed indices
+		};
+
+		std::vector<std::unique_ptr<Node>> nodes;	// Only the first nNodes are part of the graph
+		int nNodes = 0;
+		std::vector<std::pair<int, int>> edges;		// (predecessor, successor)
+		std::vector<int> successorStarts;			// Successors of node i are successors[successorStarts[i], successorStarts[i + 1])
+		std::vector<int> successors;
+		std::vector<int> roots;
+
+		PoolType* pool = nullptr;
+		std::atomic<int> nPending;					// Nodes of the current run yet to complete
+
+		//! Nodes ready to run on the caller
+		std::mutex callerMutex;
+		std::condition_variable callerCond;
+		std::vector<int> callerQueue;
+		int callerHead = 0;
+
+	public:
+		TaskGraph() : nPending(0) {}
+
+		//! Clear
+		//! Removes all nodes and edges, keeping their storage
+		//! 
+		void Clear() {
+			nNodes = 0;
+			edges.clear();
+		}
+
+		//! AddNode
+		//! Adds a node processing [begin, end) in chunks of at most grain indices on the pool. Returns its index
+		//! 
+		int AddNode(int begin, int end, int grain, const RangeFunction& function) {
+			if (nNodes == nodes.size()) {
+				nodes.push_back(std::make_unique<Node>());
+			}
+
+			Node& node = *nodes[nNodes];
+			node.function = function;
+			node.begin = begin;
+			node.end = end;
+			node.grain = grain;
+			node.runOnCaller = false;
+			return nNodes++;
+		}
+
+		//! AddCallerNode
+		//! Adds a node that runs function(0, 1) on the thread calling Run. Returns its index
+		//! 
+		int AddCallerNode(const RangeFunction& function) {
+			int nodeIdx = AddNode(0, 1, 1, function);
+			nodes[nodeIdx]->runOnCaller = true;
+			return nodeIdx;
+		}
+
+		//! AddEdge
+		//! Orders the successor after the predecessor
+		//! 
+		void AddEdge(int predecessorIdx, int successorIdx) {
+			edges.push_back({ predecessorIdx, successorIdx });
+		}
+
+		//! SetRange
+		//! Sets the range of a node. While the graph runs, only predecessors of the node may call this
+		//! 
+		void SetRange(int nodeIdx, int begin, int end) {
+			nodes[nodeIdx]->begin = begin;
+			nodes[nodeIdx]->end = end;
+		}
+
+		//! Run
+		//! Executes the graph on the given pool, running caller nodes on this thread, and blocks until every node completes
+		//! 
+		void Run(PoolType& pool) {
+			if (nNodes == 0) {
+				return;
+			}
+
+			this->pool = &pool;
+			_BuildSuccessors();
+
+			callerQueue.clear();
+			callerHead = 0;
+			nPending.store(nNodes, std::memory_order_relaxed);
+			for (int nodeI = 0; nodeI < nNodes; nodeI++) {
+				nodes[nodeI]->nWaiting.store(0, std::memory_order_relaxed);
+			}
+			for (const std::pair<int, int>& edge : edges) {
+				nodes[edge.second]->nWaiting.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			//! Collect the roots before launching any, since completing nodes update the counters
+			roots.clear();
+			for (int nodeI = 0; nodeI < nNodes; nodeI++) {
+				if (nodes[nodeI]->nWaiting.load(std::memory_order_relaxed) == 0) {
+					roots.push_back(nodeI);
+				}
+			}
+			if (roots.empty()) {
+				LOG_ERROR("TaskGraph: Graph has no root node");
+				return;
+			}
+			for (int rootIdx : roots) {
+				_Launch(rootIdx);
+			}
+
+			//! Serve caller nodes until the graph completes
+			std::unique_lock<std::mutex> lock(callerMutex);
+			while (true) {
+				callerCond.wait(lock, [this]() {
+					return callerHead < callerQueue.size() || nPending.load(std::memory_order_acquire) == 0;
+				});
+				if (callerHead == callerQueue.size()) {
+					break;
+				}
+
+				int nodeIdx = callerQueue[callerHead++];
+				lock.unlock();
+				nodes[nodeIdx]->function(0, 1);
+				_Complete(nodeIdx);
+				lock.lock();
+			}
+		}
+
+	private:
+		//! _BuildSuccessors
+		//! Groups the edges by predecessor
+		//! 
+		void _BuildSuccessors() {
+			successorStarts.assign(nNodes + 1, 0);
+			for (const std::pair<int, int>& edge : edges) {
+				successorStarts[edge.first + 1]++;
+			}
+			for (int nodeI = 0; nodeI < nNodes; nodeI++) {
+				successorStarts[nodeI + 1] += successorStarts[nodeI];
+			}
+
+			//! Filling advances each start to the next node's start; shift them back afterwards
+			successors.resize(edges.size());
+			for (const std::pair<int, int>& edge : edges) {
+				successors[successorStarts[edge.first]++] = edge.second;
+			}
+			for (int nodeI = nNodes; nodeI > 0; nodeI--) {
+				successorStarts[nodeI] = successorStarts[nodeI - 1];
+			}
+			successorStarts[0] = 0;
+		}
+
+		//! _Launch
+		//! Starts a node whose predecessors have all completed
+		//! 
+		void _Launch(int nodeIdx) {
+			Node& node = *nodes[nodeIdx];
+
+			if (node.runOnCaller) {
+				{
+					std::lock_guard<std::mutex> lock(callerMutex);
+					callerQueue.push_back(nodeIdx);
+				}
+				callerCond.notify_one();
+				return;
+			}
+
+			if (node.end <= node.begin) {
+				_Complete(nodeIdx);
+				return;
+			}
+
+			node.remaining.store(node.end - node.begin, std::memory_order_relaxed);
+			pool->ParallelForAsync(node.begin, node.end, node.grain, [this, nodeIdx](int begin, int end) {
+				Node& node = *nodes[nodeIdx];
+				node.function(begin, end);
+				if (node.remaining.fetch_sub(end - begin, std::memory_order_acq_rel) == end - begin) {
+					_Complete(nodeIdx);
+				}
+			});
+		}
+
+		//! _Complete
+		//! Launches the successors left without pending predecessors and wakes the caller once the graph is done
+		//! 
+		void _Complete(int nodeIdx) {
+			for (int succI = successorStarts[nodeIdx]; succI < successorStarts[nodeIdx + 1]; succI++) {
+				int successorIdx = successors[succI];
+				if (nodes[successorIdx]->nWaiting.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+					_Launch(successorIdx);
+				}
+			}
+
+			if (nPending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				{
+					std::lock_guard<std::mutex> lock(callerMutex);
+				}
+				callerCond.notify_all();
+			}
+		}
+	};
+
+}; // namespace Util
@@ -19,6 +19,7 @@ namespace Util {
 		void* args;
 
 		bool isStarted;
+		int affinityCpu;	// Processor to pin to, or -1 to let the OS schedule freely
 
 	public:
 		Thread(std::string name);
@@ -28,6 +29,7 @@ namespace Util {
 
 		//! Interface functions
 		void Start(void* args);
+		void SetAffinity(int cpu);
 		static void Sleep(unsigned int millis);
 		void Join();
 		const std::string& GetName() const;
@@ -39,6 +41,7 @@ namespace Util {
 
 	private:
 		void Runner();
+		bool _ApplyAffinity();
 
 	};
 
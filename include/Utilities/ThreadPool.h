@@ -1,175 +1,468 @@
 //!
 //! ThreadPool.h
 //! Manages a set of threads and delegates tasking
-//! 
+//!
 #pragma once
 
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
 #include "Thread.h"
 #include "WorkerThread.h"
-#include <queue>
+#include "WorkStealingDeque.h"
+#include "CountdownLatch.h"
+#include "CpuTopology.h"
 
 
 
 
 namespace Util {
 
+	//! ThreadPool
+	//! Work-stealing pool. Each worker owns a lock-free deque of jobs, where a job is a contiguous
+	//! index range of a submission. Workers split large ranges in half, keep working on the lower half and
+	//! push the upper half onto their own deque for idle workers to steal. Work submitted from outside the
+	//! pool enters through a shared injection queue, which is touched once per submission rather than per task
+	//! Submission state is recycled through an arena, so steady-state dispatch does not allocate
+	//!
 	template <class WorkerThreadType>
 	class ThreadPool {
-		using TaskType = typename WorkerThreadType::value_type;
-		static_assert(isWorkerThread<WorkerThreadType>::value, "ThreadType must derive from WorkerThread<TaskType>");
+		static_assert(std::is_base_of<WorkerThread, WorkerThreadType>::value, "WorkerThreadType must derive from WorkerThread");
+
+	public:
+		using RangeFunction = std::function<void(int begin, int end)>;
 
 	private:
+		struct Range;
+
+		//! Job
+		//! Index range [begin, end) of a submission
+		//!
+		struct Job {
+			Range* range;
+			int begin, end;
+		};
+
+		//! Range
+		//! Shared state of one submission
+		//!
+		struct Range {
+			RangeFunction function;
+			CountdownLatch* latch;				// Counted down once the submission completes, if set
+			int begin, end;
+			int grain;
+
+			std::vector<Job> jobs;				// Job storage, sized for the maximum number of splits
+			std::atomic<int> nextJob;
+			std::atomic<int> remaining;			// Unprocessed indices
+
+			Range() : latch(nullptr), begin(0), end(0), grain(1), nextJob(0), remaining(0) {}
+			void Reset(int begin, int end, int grain);
+			Job* AllocateJob(int begin, int end);
+		};
+
+		//! Per-worker scheduling state
+		struct alignas(64) Worker {
+			WorkStealingDeque<Job*> deque;
+			uint32_t rngState;					// Victim selection
+			int node;							// NUMA node the worker is pinned to; 0 when unpinned
+		};
+
 		int nThreads;
-		std::queue<TaskType> taskQueue;
-		std::vector<std::unique_ptr<WorkerThreadType>> threads; 
-		std::queue<int> idleThreadIdx;	// Shared
+		std::vector<std::unique_ptr<WorkerThreadType>> threads;
+		std::vector<std::unique_ptr<Worker>> workers;
 		std::string name;
 		bool isActive;
-		std::mutex taskQueueMutex, idlePoolMutex;
-		std::condition_variable idleCond;
+
+		//! Injection queue for submissions from outside the pool; a ring that only grows
+		std::mutex injectMutex;
+		std::vector<Job*> injectQueue;
+		int injectHead;
+		std::atomic<int> injectCount;
+
+		//! Parking of idle workers
+		std::mutex parkMutex;
+		std::condition_variable parkCond;
+		std::atomic<uint64_t> workEpoch;		// Advanced whenever new jobs become visible
+		std::atomic<int> nParked;
+		std::atomic<bool> isStopping;
+
+		//! Submission arena
+		std::mutex arenaMutex;
+		std::vector<std::unique_ptr<Range>> ranges;	// Every range allocated so far
+		std::vector<Range*> freeRanges;
+
+		CountdownLatch pendingLatch;			// Incomplete submissions
 
 	public:
 		//! Constructors
-		//! 
+		//!
 		ThreadPool(std::string name, int nThreads)
 			: name(name)
 			, nThreads(nThreads)
 			, isActive(false)
+			, injectHead(0)
+			, injectCount(0)
+			, workEpoch(0)
+			, nParked(0)
+			, isStopping(false)
+			, pendingLatch(0)
 		{}
 
 		//! Interface functions
-		//! 
-		void Init();
-		void AddTasks(std::vector<TaskType>& tasks);
-		void AddTask(TaskType& task);
+		//!
+		void Init(bool pinThreads = false);
+		void ParallelFor(int begin, int end, int grain, const RangeFunction& function);
+		void ParallelForAsync(int begin, int end, int grain, const RangeFunction& function, CountdownLatch* latch = nullptr);
 		void WaitIdle();
 		void Shutdown();
-		
+
+	private:
+		//! Helper functions
+		Range* _AcquireRange(int begin, int end, int grain);
+		void _ReleaseRange(Range* range);
+		void _Submit(Range* range);
+		void _Notify();
+		Job* _FindJob(int workerIdx);
+		void _Execute(int workerIdx, Job* job);
+		int _RunWorker(int workerIdx);
 	};
 
+	/* ------------------------------------------------------------------------
+	 * Range
+	 * ------------------------------------------------------------------------ */
+
+	//! Reset
+	//! Prepares the range for a new submission, reusing its job storage
+	//! Ranges split down to chunks of at most grain indices, producing at most 2 * ceil(n / grain) jobs
+	//!
+	template <class WorkerThreadType>
+	void ThreadPool<WorkerThreadType>::Range::Reset(int begin, int end, int grain) {
+		this->begin = begin;
+		this->end = end;
+		this->grain = std::max(grain, 1);
+		latch = nullptr;
+		nextJob.store(0, std::memory_order_relaxed);
+		remaining.store(end - begin, std::memory_order_relaxed);
+
+		int nChunks = (end - begin + this->grain - 1) / this->grain;
+		if (jobs.size() < 2 * nChunks + 1) {
+			jobs.resize(2 * nChunks + 1);
+		}
+	}
+
+	//! AllocateJob
+	//! Claims the next job slot of the range. Safe from any thread
+	//!
+	template <class WorkerThreadType>
+	typename ThreadPool<WorkerThreadType>::Job* ThreadPool<WorkerThreadType>::Range::AllocateJob(int begin, int end) {
+		Job* job = &jobs[nextJob.fetch_add(1, std::memory_order_relaxed)];
+		job->range = this;
+		job->begin = begin;
+		job->end = end;
+		return job;
+	}
+
+	/* ------------------------------------------------------------------------
+	 * ThreadPool
+	 * ------------------------------------------------------------------------ */
+
 	//! Init
 	//! Initializes thread pool child threads to an active state
-	//! 
+	//! With pinning, workers occupy physical cores node by node before SMT siblings and steal from their own node first
+	//!
 	template <class WorkerThreadType>
-	void ThreadPool<WorkerThreadType>::Init() {
+	void ThreadPool<WorkerThreadType>::Init(bool pinThreads) {
+		isStopping.store(false);
+
+		std::vector<CpuTopology::Processor> placement;
+		if (pinThreads) {
+			placement = CpuTopology::Detect().GetPlacementOrder();
+			if (nThreads > placement.size()) {
+				LOG_WARN(name + ": More threads than processors; pinned threads will share processors");
+			}
+		}
+
+		for (int threadIdx = 0; threadIdx < nThreads; threadIdx++) {
+			workers.push_back(std::make_unique<Worker>());
+			workers[threadIdx]->rngState = 0x9E3779B9u * (threadIdx + 1);
+			workers[threadIdx]->node = placement.empty() ? 0 : placement[threadIdx % placement.size()].node;
+		}
+
 		//! Instantiate threads
 		for (int threadIdx = 0; threadIdx < nThreads; threadIdx++) {
 			threads.push_back(std::make_unique<WorkerThreadType>(
-				name + "_" + std::to_string(threadIdx), [threadIdx, this](WorkerThread<TaskType>* thread, bool success) {
-					if (!success) {
-						Util::Log::Error(name + "_" + std::to_string(threadIdx) + ": Failed to accomplish task");
-					}
-
-					std::lock_guard<std::mutex> lock(taskQueueMutex);
-
-					if (!taskQueue.empty()) {
-						//! Acquire new tasking
-						TaskType task = std::move(taskQueue.front());
-						taskQueue.pop();
-						thread->SetTask(std::move(task));
-					}
-					else {
-						//! Thread is now idle
-						idleThreadIdx.push(threadIdx);
-
-						//! Signal thread pool on empty task queue
-						if (this->idleThreadIdx.size() == nThreads) {
-							idleCond.notify_one();
-						}
-					}
+				name + "_" + std::to_string(threadIdx), [threadIdx, this]() {
+					return _RunWorker(threadIdx);
 				}
 			));
 
-			//! Add thread to idle queue
-			idleThreadIdx.push(threadIdx);
+			if (!placement.empty()) {
+				threads[threadIdx]->SetAffinity(placement[threadIdx % placement.size()].cpu);
+			}
 
 			//! Start the thread
 			threads[threadIdx]->Start(nullptr);	// TODO: Hide arguments from start()
-			Util::Log::Debug(threads[threadIdx]->GetName() + ": Initialized thread");
+			LOG_DEBUG(threads[threadIdx]->GetName() + ": Initialized thread");
 		}
 
 		isActive = true;
-		Util::Log::Debug("ThreadPool: Successfully initialized thread pool with name " + name);
+		LOG_DEBUG("ThreadPool: Successfully initialized thread pool with name " + name);
 	}
 
-	//! AddTasks
-	//! Delegates a set of tasks to be processed by the thread pool
-	//! 
+	//! ParallelFor
+	//! Invokes function(chunkBegin, chunkEnd) over [begin, end) in chunks of at most grain indices
+	//! Blocks until all chunks are processed. Must not be called from a worker of this pool
+	//!
 	template <class WorkerThreadType>
-	void ThreadPool<WorkerThreadType>::AddTasks(std::vector<TaskType>& tasks) {
+	void ThreadPool<WorkerThreadType>::ParallelFor(int begin, int end, int grain, const RangeFunction& function) {
+		if (end <= begin) {
+			return;
+		}
+
 		if (!isActive) {
-			Util::Log::Warn("Attempted to add tasks on an inactive thread pool");
+			LOG_WARN("Attempted a parallel for on an inactive thread pool");
 			return;
 		}
 
-		{
-			std::lock_guard<std::mutex> lock(taskQueueMutex);
-
-			//! Dispatch to all idle workers as applicable
-			int nTasks = tasks.size();
-			int idleThreadCount = this->idleThreadIdx.size();
-			int nAssignments = std::min(nTasks, idleThreadCount);
-
-			for (int taskI = 0; taskI < nAssignments; taskI++) {
-				int threadIdx = idleThreadIdx.front();
-				idleThreadIdx.pop();
-				threads[threadIdx]->SetTask(std::move(tasks[taskI]));
-				Util::Log::Debug(name + ": Added task (ID: " + std::to_string(tasks[taskI].GetUID()) + ") to worker thread (" + threads[threadIdx]->GetName() + ")");
-			}
+		CountdownLatch latch(1);
+		ParallelForAsync(begin, end, grain, function, &latch);
+		latch.Wait();
+	}
 
-			//! Add remaining tasks to the pending queue
-			for (int taskI = nAssignments; taskI < nTasks; taskI++) {
-				taskQueue.push(std::move(tasks[taskI]));
-				Util::Log::Debug(name + ": Added task (ID: " + std::to_string(tasks[taskI].GetUID()) + " to work queue");
+	//! ParallelForAsync
+	//! Invokes function(chunkBegin, chunkEnd) over [begin, end) in chunks of at most grain indices
+	//! Returns immediately; completion is awaited through the given latch, counted down once, or WaitIdle
+	//!
+	template <class WorkerThreadType>
+	void ThreadPool<WorkerThreadType>::ParallelForAsync(int begin, int end, int grain, const RangeFunction& function, CountdownLatch* latch) {
+		if (end <= begin || !isActive) {
+			if (!isActive) {
+				LOG_WARN("Attempted a parallel for on an inactive thread pool");
+			}
+			if (latch) {
+				latch->CountDown();
 			}
+			return;
 		}
+
+		Range* range = _AcquireRange(begin, end, grain);
+		range->function = function;
+		range->latch = latch;
+		_Submit(range);
 	}
 
-	//! AddTask
-	//! Delegates a task to be processed by the thread pool
-	//! 
+	//! WaitIdle
+	//! Blocks until all submissions are processed
+	//!
 	template <class WorkerThreadType>
-	void ThreadPool<WorkerThreadType>::AddTask(TaskType& task) {
-		if (!isActive) {
-			Util::Log::Warn("Attempted to add a task on an inactive thread pool");
-			return;
+	void ThreadPool<WorkerThreadType>::WaitIdle() {
+		LOG_DEBUG(name + ": Waiting for tasks to complete");
+		pendingLatch.Wait();
+		LOG_DEBUG(name + ": Tasks complete");
+	}
+
+	//! Shutdown
+	//! Shuts down all active threads in the pool
+	//! Pending jobs are abandoned
+	//!
+	template <class WorkerThreadType>
+	void ThreadPool<WorkerThreadType>::Shutdown() {
+		{
+			std::lock_guard<std::mutex> lock(parkMutex);
+			isStopping.store(true);
 		}
+		parkCond.notify_all();
 
+		for (auto& thread : threads) {
+			thread->Stop();
+		}
+		threads.clear();
+		workers.clear();
+		isActive = false;
+	}
+
+	//! _AcquireRange
+	//! Takes a range from the arena, allocating only while the arena warms up
+	//!
+	template <class WorkerThreadType>
+	typename ThreadPool<WorkerThreadType>::Range* ThreadPool<WorkerThreadType>::_AcquireRange(int begin, int end, int grain) {
+		Range* range = nullptr;
 		{
-			std::lock_guard<std::mutex> lock(taskQueueMutex);
-
-			//! Check for an idle worker to immediately provide the task
-			if (!idleThreadIdx.empty()) {
-				int threadIdx = idleThreadIdx.front();
-				idleThreadIdx.pop();
-				threads[threadIdx]->SetTask(std::move(task));
-				Util::Log::Debug(name + ": Added task (ID: " + std::to_string(task.GetUID()) + ") to worker thread (" + threads[threadIdx]->GetName() + ")");
+			std::lock_guard<std::mutex> lock(arenaMutex);
+			if (freeRanges.empty()) {
+				ranges.push_back(std::make_unique<Range>());
+				freeRanges.reserve(ranges.size());
+				range = ranges.back().get();
 			}
 			else {
-				//! Add task to the pending queue since no worker is available
-				taskQueue.push(std::move(task));
-				Util::Log::Debug(name + ": Added task (ID: " + std::to_string(task.GetUID()) + " to work queue");
+				range = freeRanges.back();
+				freeRanges.pop_back();
 			}
 		}
+
+		range->Reset(begin, end, grain);
+		return range;
 	}
 
+	//! _ReleaseRange
+	//! Returns a completed range to the arena, keeping its storage
+	//!
 	template <class WorkerThreadType>
-	void ThreadPool<WorkerThreadType>::WaitIdle() {
-		Util::Log::Debug(name + ": Waiting for tasks to complete");
-		std::unique_lock<std::mutex> lock(idlePoolMutex);
-		idleCond.wait(lock, [&]() { return idleThreadIdx.size() == nThreads; });
-		Util::Log::Debug(name + ": Tasks complete");
+	void ThreadPool<WorkerThreadType>::_ReleaseRange(Range* range) {
+		range->function = nullptr;
+
+		std::lock_guard<std::mutex> lock(arenaMutex);
+		freeRanges.push_back(range);
 	}
 
-	//! Shutdown
-	//! Shuts down all active threads in the pool
-	//! 
+	//! _Submit
+	//! Enqueues the whole range as a single job on the injection queue
+	//!
 	template <class WorkerThreadType>
-	void ThreadPool<WorkerThreadType>::Shutdown() {
-		for (auto& thread : threads) {
-			thread->Stop();
+	void ThreadPool<WorkerThreadType>::_Submit(Range* range) {
+		pendingLatch.Add();
+		Job* job = range->AllocateJob(range->begin, range->end);
+
+		{
+			std::lock_guard<std::mutex> lock(injectMutex);
+			int count = injectCount.load(std::memory_order_relaxed);
+			if (count == injectQueue.size()) {
+				//! Full; unroll the ring into a larger one
+				std::vector<Job*> grown(std::max<size_t>(16, 2 * injectQueue.size()));
+				for (int jobI = 0; jobI < count; jobI++) {
+					grown[jobI] = injectQueue[(injectHead + jobI) % injectQueue.size()];
+				}
+				injectQueue.swap(grown);
+				injectHead = 0;
+			}
+
+			injectQueue[(injectHead + count) % injectQueue.size()] = job;
+			injectCount.store(count + 1, std::memory_order_release);
+		}
+		_Notify();
+	}
+
+	//! _Notify
+	//! Wakes a parked worker after new jobs became visible
+	//!
+	template <class WorkerThreadType>
+	void ThreadPool<WorkerThreadType>::_Notify() {
+		workEpoch.fetch_add(1, std::memory_order_seq_cst);
+		if (nParked.load(std::memory_order_seq_cst) > 0) {
+			//! Serialize with a worker between its predicate check and its wait
+			{
+				std::lock_guard<std::mutex> lock(parkMutex);
+			}
+			parkCond.notify_one();
+		}
+	}
+
+	//! _FindJob
+	//! Takes a job from the worker's own deque, then the injection queue, then a random victim
+	//! Returns nullptr if no work was found
+	//!
+	template <class WorkerThreadType>
+	typename ThreadPool<WorkerThreadType>::Job* ThreadPool<WorkerThreadType>::_FindJob(int workerIdx) {
+		Worker& worker = *workers[workerIdx];
+		Job* job = nullptr;
+
+		if (worker.deque.Pop(job)) {
+			return job;
 		}
+
+		if (injectCount.load(std::memory_order_acquire) > 0) {
+			std::lock_guard<std::mutex> lock(injectMutex);
+			int count = injectCount.load(std::memory_order_relaxed);
+			if (count > 0) {
+				job = injectQueue[injectHead];
+				injectHead = (injectHead + 1) % injectQueue.size();
+				injectCount.store(count - 1, std::memory_order_relaxed);
+				return job;
+			}
+		}
+
+		//! Probe every other worker once, starting at a random victim; workers on the same node go first
+		if (nThreads > 1) {
+			worker.rngState ^= worker.rngState << 13;
+			worker.rngState ^= worker.rngState >> 17;
+			worker.rngState ^= worker.rngState << 5;
+
+			int start = worker.rngState % nThreads;
+			for (int pass = 0; pass < 2; pass++) {
+				for (int probeI = 0; probeI < nThreads; probeI++) {
+					int victimIdx = (start + probeI) % nThreads;
+					bool isLocal = workers[victimIdx]->node == worker.node;
+					if (victimIdx != workerIdx && isLocal == (pass == 0) && workers[victimIdx]->deque.Steal(job)) {
+						return job;
+					}
+				}
+			}
+		}
+
+		return nullptr;
+	}
+
+	//! _Execute
+	//! Splits the job until it fits the grain, then processes it
+	//!
+	template <class WorkerThreadType>
+	void ThreadPool<WorkerThreadType>::_Execute(int workerIdx, Job* job) {
+		Range* range = job->range;
+		int begin = job->begin;
+		int end = job->end;
+
+		//! Leave the upper halves for thieves
+		while (end - begin > range->grain) {
+			int mid = begin + (end - begin) / 2;
+			workers[workerIdx]->deque.Push(range->AllocateJob(mid, end));
+			_Notify();
+			end = mid;
+		}
+
+		range->function(begin, end);
+
+		//! The last chunk completes the submission; the range is recycled before anyone is released
+		if (range->remaining.fetch_sub(end - begin, std::memory_order_acq_rel) == end - begin) {
+			CountdownLatch* latch = range->latch;
+			_ReleaseRange(range);
+
+			if (latch) {
+				latch->CountDown();
+			}
+			pendingLatch.CountDown();
+		}
+	}
+
+	//! _RunWorker
+	//! Scheduling loop of a worker thread. Parks once no work can be found
+	//!
+	template <class WorkerThreadType>
+	int ThreadPool<WorkerThreadType>::_RunWorker(int workerIdx) {
+		while (!isStopping.load(std::memory_order_relaxed)) {
+			Job* job = _FindJob(workerIdx);
+			if (job) {
+				_Execute(workerIdx, job);
+				continue;
+			}
+
+			//! Rescan after sampling the epoch such that no publication is missed before parking
+			uint64_t epoch = workEpoch.load(std::memory_order_seq_cst);
+			job = _FindJob(workerIdx);
+			if (job) {
+				_Execute(workerIdx, job);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(parkMutex);
+			nParked.fetch_add(1, std::memory_order_seq_cst);
+			parkCond.wait(lock, [&]() { return isStopping.load() || workEpoch.load(std::memory_order_seq_cst) != epoch; });
+			nParked.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		return 0;
 	}
 
-}; // namespace Util
\ No newline at end of file
+}; // namespace Util
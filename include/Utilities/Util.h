@@ -5,8 +5,14 @@
 #pragma once
 
 #include "Constants.h"
+#include "Real.h"
 #include "Log.h"
 #include "Vector2.h"
 #include "Vector3.h"
 #include "Rotation.h"
 #include "Transform.h"
+#include "AABB.h"
+#include "AlignedAllocator.h"
+#include "Simd.h"
+#include "RayPacket.h"
+#include "Morton.h"
@@ -15,13 +15,17 @@ namespace Util {
 		Vector3(T x, T y, T z) : x(x), y(y), z(z) {}
 		Vector3() : x(0), y(0), z(0) {}
 
+		//! Converts between precisions
+		template <typename U>
+		explicit Vector3(const Vector3<U>& other) : x(T(other.x)), y(T(other.y)), z(T(other.z)) {}
+
 		//! Utility functions
-		double Magnitude() const {
+		T Magnitude() const {
 			return std::sqrt(x * x + y * y + z * z);
 		}
 
 		Vector3<T> Normalized() const {
-			double magnitude = Magnitude();
+			T magnitude = Magnitude();
 			if (magnitude == 0) {
 				return Vector3<T>(0, 0, 0);
 			}
@@ -30,7 +34,7 @@ namespace Util {
 		}
 
 		void Normalize() {
-			double magnitude = Magnitude();
+			T magnitude = Magnitude();
 			if (magnitude == 0) {
 				return;
 			}
@@ -62,6 +66,11 @@ namespace Util {
 			);
 		}
 
+		//! Component-wise product
+		Vector3<T> Multiply(const Vector3<T>& other) const {
+			return Vector3<T>(x * other.x, y * other.y, z * other.z);
+		}
+
 		double AngleBetween(const Vector3<T>& other) const {
 			return std::acos(this->Dot(other) / (this->Magnitude() * other.Magnitude()));
 		}
@@ -84,6 +93,9 @@ namespace Util {
 		Vector3<T> operator-(const Vector3<T>& other) const {
 			return Vector3<T>(x - other.x, y - other.y, z - other.z);
 		}
+		T operator[](int axis) const {
+			return axis == 0 ? x : (axis == 1 ? y : z);
+		}
 	};
 
 }; // namespace Util
\ No newline at end of file
@@ -0,0 +1,166 @@
+//!
+//! WorkStealingDeque.h
+//! Lock-free single owner, multiple thief deque (Chase-Lev)
+//!
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+
+
+namespace Util {
+
+	//! WorkStealingDeque
+	//! The owning thread pushes and pops at the bottom while any other thread steals from the top
+	//! Items must be trivially copyable, such as pointers to jobs
+	//!
+	template <typename T>
+	class WorkStealingDeque {
+	private:
+		//! Buffer
+		//! Circular array of atomic slots with a power of two capacity
+		//!
+		struct Buffer {
+			int64_t capacity;
+			std::unique_ptr<std::atomic<T>[]> slots;
+
+			Buffer(int64_t capacity) : capacity(capacity), slots(new std::atomic<T>[capacity]) {}
+			T Load(int64_t idx) const { return slots[idx & (capacity - 1)].load(std::memory_order_relaxed); }
+			void Store(int64_t idx, T item) { slots[idx & (capacity - 1)].store(item, std::memory_order_relaxed); }
+		};
+
+		alignas(64) std::atomic<int64_t> top;		// Next item to steal
+		alignas(64) std::atomic<int64_t> bottom;	// Next free slot of the owner
+		std::atomic<Buffer*> buffer;
+		std::vector<std::unique_ptr<Buffer>> buffers;	// Outgrown buffers are kept since thieves may still read them
+
+	public:
+		//! Constructors
+		explicit WorkStealingDeque(int64_t capacity = 256);
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		//! Owner interface
+		void Push(T item);
+		bool Pop(T& item);
+
+		//! Thief interface
+		bool Steal(T& item);
+
+		//! Accessors
+		bool IsEmpty() const;
+
+	private:
+		//! Helper functions
+		Buffer* _Grow(Buffer* current, int64_t topIdx, int64_t bottomIdx);
+	};
+
+	//! Constructor
+	//! Capacity is rounded up to a power of two; the deque grows as needed
+	//!
+	template <typename T>
+	WorkStealingDeque<T>::WorkStealingDeque(int64_t capacity)
+		: top(0)
+		, bottom(0)
+	{
+		int64_t roundedCapacity = 1;
+		while (roundedCapacity < capacity) {
+			roundedCapacity <<= 1;
+		}
+
+		buffers.push_back(std::make_unique<Buffer>(roundedCapacity));
+		buffer.store(buffers.back().get(), std::memory_order_relaxed);
+	}
+
+	//! Push
+	//! Adds an item at the bottom. Owner only
+	//!
+	template <typename T>
+	void WorkStealingDeque<T>::Push(T item) {
+		int64_t bottomIdx = bottom.load(std::memory_order_relaxed);
+		int64_t topIdx = top.load(std::memory_order_acquire);
+		Buffer* current = buffer.load(std::memory_order_relaxed);
+
+		if (bottomIdx - topIdx > current->capacity - 1) {
+			current = _Grow(current, topIdx, bottomIdx);
+		}
+
+		current->Store(bottomIdx, item);
+		bottom.store(bottomIdx + 1, std::memory_order_release);
+	}
+
+	//! Pop
+	//! Removes the most recently pushed item. Owner only
+	//! Returns false if the deque is empty or the last item was stolen concurrently
+	//!
+	template <typename T>
+	bool WorkStealingDeque<T>::Pop(T& item) {
+		int64_t bottomIdx = bottom.load(std::memory_order_relaxed) - 1;
+		Buffer* current = buffer.load(std::memory_order_relaxed);
+		bottom.store(bottomIdx, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t topIdx = top.load(std::memory_order_relaxed);
+
+		if (topIdx > bottomIdx) {
+			//! Empty
+			bottom.store(bottomIdx + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		item = current->Load(bottomIdx);
+		if (topIdx < bottomIdx) {
+			return true;	// More than one item left, no thief can reach this one
+		}
+
+		//! Last item; race thieves for it
+		bool isWon = top.compare_exchange_strong(topIdx, topIdx + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		bottom.store(bottomIdx + 1, std::memory_order_relaxed);
+		return isWon;
+	}
+
+	//! Steal
+	//! Removes the least recently pushed item. Any thread
+	//! Returns false if the deque is empty or another thread took the item first
+	//!
+	template <typename T>
+	bool WorkStealingDeque<T>::Steal(T& item) {
+		int64_t topIdx = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t bottomIdx = bottom.load(std::memory_order_acquire);
+
+		if (topIdx >= bottomIdx) {
+			return false;
+		}
+
+		item = buffer.load(std::memory_order_acquire)->Load(topIdx);
+		return top.compare_exchange_strong(topIdx, topIdx + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	//! IsEmpty
+	//! Returns whether the deque appeared empty at the time of the call
+	//!
+	template <typename T>
+	bool WorkStealingDeque<T>::IsEmpty() const {
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+	//! _Grow
+	//! Moves the live items into a buffer of twice the capacity
+	//!
+	template <typename T>
+	typename WorkStealingDeque<T>::Buffer* WorkStealingDeque<T>::_Grow(Buffer* current, int64_t topIdx, int64_t bottomIdx) {
+		buffers.push_back(std::make_unique<Buffer>(current->capacity * 2));
+		Buffer* grown = buffers.back().get();
+
+		for (int64_t idx = topIdx; idx < bottomIdx; idx++) {
+			grown->Store(idx, current->Load(idx));
+		}
+
+		buffer.store(grown, std::memory_order_release);
+		return grown;
+	}
+
+}; // namespace Util
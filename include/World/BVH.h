@@ -0,0 +1,258 @@
+//!
+//! BVH.h
+//! Bounding volume hierarchy for accelerating ray collision queries
+//!
+#pragma once
+
+#include <vector>
+#include "Util.h"
+
+
+
+namespace World {
+
+	class BVH {
+	public:
+		//! Node
+		//! Flattened tree node. Children of an interior node are stored adjacently,
+		//! the left child at leftFirst and the right child at leftFirst + 1
+		//!
+		struct Node {
+			Util::AABB<Util::Real> bounds;
+			int leftFirst;	// Left child index (interior) or first primitive index (leaf)
+			int count;		// Number of primitives in the leaf, 0 for interior nodes
+
+			bool IsLeaf() const { return count > 0; }
+		};
+
+	private:
+		//! Properties
+		static constexpr int binCount = 16;			// SAH candidate splits per axis
+		static constexpr int maxLeafSize = 4;		// Leaves are always split beyond this size
+		static constexpr int maxDepth = 64;			// Also bounds the traversal stack
+		static constexpr double traversalCost = 1.0;
+		static constexpr double intersectCost = 1.0;
+
+		std::vector<Node> nodes;
+		std::vector<int> primIndices;	// Primitive indices ordered by leaf
+		int batchSize = 1;				// Primitives intersected together by the leaf kernel
+
+	public:
+		//! Interface functions
+		void Build(const std::vector<Util::AABB<Util::Real>>& primBounds, int batchSize = 1);
+		void Clear();
+
+		template <typename LeafFn>
+		void Traverse(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real& tMax, LeafFn&& leafFn) const;
+		template <typename LeafFn>
+		void TraversePacket(Util::RayPacket& packet, LeafFn&& leafFn) const;
+
+		//! Accessors
+		bool IsEmpty() const;
+		const std::vector<Node>& GetNodes() const;
+		const std::vector<int>& GetPrimitiveIndices() const;
+
+	private:
+		//! Helper functions
+		void _Subdivide(int nodeIdx, int depth, const std::vector<Util::AABB<Util::Real>>& primBounds, const std::vector<Util::Vector3<Util::Real>>& centroids);
+		void _UpdateBounds(int nodeIdx, const std::vector<Util::AABB<Util::Real>>& primBounds);
+		int _GetBatchCount(int primCount) const;
+
+		//! Packet helpers
+		struct PacketInverse {
+			alignas(32) Util::Real x[Util::RayPacket::maxSize];
+			alignas(32) Util::Real y[Util::RayPacket::maxSize];
+			alignas(32) Util::Real z[Util::RayPacket::maxSize];
+		};
+		static Util::Real _IntersectPacket(const Util::AABB<Util::Real>& bounds, const Util::RayPacket& packet, const PacketInverse& invDir);
+	};
+
+	//! Traverse
+	//! Walks the hierarchy front-to-back along the given ray, invoking leafFn(first, count) for every
+	//! leaf whose bounds are entered before tMax. The range indexes GetPrimitiveIndices(), which is the
+	//! identity once primitive storage is reordered to match. leafFn may shrink tMax to cull farther
+	//! nodes, and returns true to terminate the traversal early
+	//!
+	template <typename LeafFn>
+	void BVH::Traverse(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real& tMax, LeafFn&& leafFn) const {
+		if (nodes.empty()) {
+			return;
+		}
+
+		const Util::Vector3<Util::Real> invDir(Util::Real(1) / direction.x, Util::Real(1) / direction.y, Util::Real(1) / direction.z);
+
+		int stack[maxDepth * 2];
+		int stackSize = 0;
+		int nodeIdx = 0;
+
+		if (nodes[0].bounds.IntersectRay(origin, invDir, tMax) == INFINITY) {
+			return;
+		}
+
+		while (true) {
+			const Node& node = nodes[nodeIdx];
+
+			if (node.IsLeaf()) {
+				//! Test all primitives of the leaf
+				if (leafFn(node.leftFirst, node.count)) {
+					return;
+				}
+			}
+			else {
+				//! Descend into the nearer child first, defer the farther one
+				int nearIdx = node.leftFirst;
+				int farIdx = node.leftFirst + 1;
+				Util::Real nearDist = nodes[nearIdx].bounds.IntersectRay(origin, invDir, tMax);
+				Util::Real farDist = nodes[farIdx].bounds.IntersectRay(origin, invDir, tMax);
+
+				if (farDist < nearDist) {
+					std::swap(nearIdx, farIdx);
+					std::swap(nearDist, farDist);
+				}
+
+				if (nearDist != INFINITY) {
+					if (farDist != INFINITY) {
+						stack[stackSize++] = farIdx;
+					}
+					nodeIdx = nearIdx;
+					continue;
+				}
+			}
+
+			//! Pop the next deferred node still in range
+			bool found = false;
+			while (stackSize > 0) {
+				nodeIdx = stack[--stackSize];
+				if (nodes[nodeIdx].bounds.IntersectRay(origin, invDir, tMax) != INFINITY) {
+					found = true;
+					break;
+				}
+			}
+
+			if (!found) {
+				return;
+			}
+		}
+	}
+
+	//! TraversePacket
+	//! Walks the hierarchy once for a whole packet of rays, invoking leafFn(first, count) for every
+	//! leaf entered by at least one ray of the packet. Rays share a single traversal order, and
+	//! leafFn is expected to shrink packet.tMax as collisions are found. The packet must be padded
+	//! to a multiple of Util::Simd<Util::Real>::width
+	//!
+	template <typename LeafFn>
+	void BVH::TraversePacket(Util::RayPacket& packet, LeafFn&& leafFn) const {
+		if (nodes.empty()) {
+			return;
+		}
+
+		//! Padding rays are included, their NaN directions never enter any bounds
+		constexpr int laneCount = Util::Simd<Util::Real>::width;
+		const int paddedCount = (packet.count + laneCount - 1) / laneCount * laneCount;
+		PacketInverse invDir;
+		for (int rayI = 0; rayI < paddedCount; rayI++) {
+			invDir.x[rayI] = Util::Real(1) / packet.dirX[rayI];
+			invDir.y[rayI] = Util::Real(1) / packet.dirY[rayI];
+			invDir.z[rayI] = Util::Real(1) / packet.dirZ[rayI];
+		}
+
+		int stack[maxDepth * 2];
+		int stackSize = 0;
+		int nodeIdx = 0;
+
+		if (_IntersectPacket(nodes[0].bounds, packet, invDir) == INFINITY) {
+			return;
+		}
+
+		while (true) {
+			const Node& node = nodes[nodeIdx];
+
+			if (node.IsLeaf()) {
+				if (leafFn(node.leftFirst, node.count)) {
+					return;
+				}
+			}
+			else {
+				//! Descend into the child the packet enters first, defer the other
+				int nearIdx = node.leftFirst;
+				int farIdx = node.leftFirst + 1;
+				Util::Real nearDist = _IntersectPacket(nodes[nearIdx].bounds, packet, invDir);
+				Util::Real farDist = _IntersectPacket(nodes[farIdx].bounds, packet, invDir);
+
+				if (farDist < nearDist) {
+					std::swap(nearIdx, farIdx);
+					std::swap(nearDist, farDist);
+				}
+
+				if (nearDist != INFINITY) {
+					if (farDist != INFINITY) {
+						stack[stackSize++] = farIdx;
+					}
+					nodeIdx = nearIdx;
+					continue;
+				}
+			}
+
+			//! Pop the next deferred node still entered by any ray
+			bool found = false;
+			while (stackSize > 0) {
+				nodeIdx = stack[--stackSize];
+				if (_IntersectPacket(nodes[nodeIdx].bounds, packet, invDir) != INFINITY) {
+					found = true;
+					break;
+				}
+			}
+
+			if (!found) {
+				return;
+			}
+		}
+	}
+
+	//! _IntersectPacket
+	//! Returns the nearest entry distance into the bounds over all rays of the packet, or INFINITY if no ray enters
+	//! Rays are tested Lanes::width at a time with the slab test of AABB::IntersectRay, whose operand order is
+	//! kept so that rays parallel to a slab resolve identically
+	//!
+	inline Util::Real BVH::_IntersectPacket(const Util::AABB<Util::Real>& bounds, const Util::RayPacket& packet, const PacketInverse& invDir) {
+		using Lanes = Util::Simd<Util::Real>;
+		const Lanes minX(bounds.min.x), minY(bounds.min.y), minZ(bounds.min.z);
+		const Lanes maxX(bounds.max.x), maxY(bounds.max.y), maxZ(bounds.max.z);
+		const Lanes zero(0), inf(INFINITY);
+
+		Lanes nearest(INFINITY);
+		for (int rayI = 0; rayI < packet.count; rayI += Lanes::width) {
+			Lanes originX = Lanes::LoadAligned(&packet.originX[rayI]), invX = Lanes::LoadAligned(&invDir.x[rayI]);
+			Lanes tx1 = (minX - originX) * invX;
+			Lanes tx2 = (maxX - originX) * invX;
+			Lanes tNear = Min(tx2, tx1);
+			Lanes tFar = Max(tx2, tx1);
+
+			Lanes originY = Lanes::LoadAligned(&packet.originY[rayI]), invY = Lanes::LoadAligned(&invDir.y[rayI]);
+			Lanes ty1 = (minY - originY) * invY;
+			Lanes ty2 = (maxY - originY) * invY;
+			tNear = Max(Min(ty2, ty1), tNear);
+			tFar = Min(Max(ty2, ty1), tFar);
+
+			Lanes originZ = Lanes::LoadAligned(&packet.originZ[rayI]), invZ = Lanes::LoadAligned(&invDir.z[rayI]);
+			Lanes tz1 = (minZ - originZ) * invZ;
+			Lanes tz2 = (maxZ - originZ) * invZ;
+			tNear = Max(Min(tz2, tz1), tNear);
+			tFar = Min(Max(tz2, tz1), tFar);
+
+			Lanes::Mask enters = (tFar >= tNear) & (tFar > zero) & (tNear < Lanes::LoadAligned(&packet.tMax[rayI]));
+			nearest = Min(Select(enters, tNear, inf), nearest);
+		}
+
+		//! Reduce the lanes; padding rays never enter
+		alignas(32) Util::Real nearestLanes[Lanes::width];
+		nearest.StoreAligned(nearestLanes);
+		Util::Real result = INFINITY;
+		for (int lane = 0; lane < Lanes::width; lane++) {
+			result = std::min(result, nearestLanes[lane]);
+		}
+		return result;
+	}
+
+}; // namespace World
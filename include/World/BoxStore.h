@@ -0,0 +1,68 @@
+//!
+//! BoxStore.h
+//! Packed structure-of-arrays storage of oriented box primitives
+//!
+#pragma once
+
+#include "PrimitiveStore.h"
+
+
+
+namespace World {
+
+	struct BoxLayout {
+		enum Field {
+			CENTER_X, CENTER_Y, CENTER_Z,
+			HALF_EXTENT_0, HALF_EXTENT_1, HALF_EXTENT_2,
+			AXIS_0_X, AXIS_0_Y, AXIS_0_Z,
+			AXIS_1_X, AXIS_1_Y, AXIS_1_Z,
+			AXIS_2_X, AXIS_2_Y, AXIS_2_Z,
+			FIELD_COUNT
+		};
+	};
+
+	class BoxStore : public PrimitiveStore<BoxStore, BoxLayout> {
+		friend class PrimitiveStore<BoxStore, BoxLayout>;
+
+	public:
+		using PrimitiveType = Box;
+		static constexpr bool isBounded = true;
+
+		//! Interface functions
+		void Add(const Box& box, int objectIdx);
+
+		//! Accessors
+		Util::AABB<Util::Real> GetBounds(int boxIdx) const;
+
+	private:
+		//! Lane kernel
+		template <typename Fetch>
+		Lanes::Mask _IntersectLanes(const LaneRay& ray, Fetch&& fetch, Lanes& tNear, Lanes& tFar) const {
+			Lanes ocx = ray.ox - fetch(CENTER_X);
+			Lanes ocy = ray.oy - fetch(CENTER_Y);
+			Lanes ocz = ray.oz - fetch(CENTER_Z);
+
+			tNear = Lanes(-INFINITY);
+			tFar = Lanes(INFINITY);
+
+			//! Slab test in the box frame
+			for (int axis = 0; axis < 3; axis++) {
+				Lanes ax = fetch(AXIS_0_X + 3 * axis);
+				Lanes ay = fetch(AXIS_0_Y + 3 * axis);
+				Lanes az = fetch(AXIS_0_Z + 3 * axis);
+				Lanes halfExtent = fetch(HALF_EXTENT_0 + axis);
+
+				Lanes localOrigin = (ocx * ax + ocy * ay) + ocz * az;
+				Lanes invDir = Lanes(1) / ((ray.dx * ax + ray.dy * ay) + ray.dz * az);
+
+				Lanes t1 = (Lanes(0) - halfExtent - localOrigin) * invDir;
+				Lanes t2 = (halfExtent - localOrigin) * invDir;
+				tNear = Max(tNear, Min(t1, t2));
+				tFar = Min(tFar, Max(t1, t2));
+			}
+
+			return tFar >= tNear;
+		}
+	};
+
+}; // namespace World
@@ -0,0 +1,48 @@
+//!
+//! Mesh.h
+//! Indexed triangle mesh with its own bounding volume hierarchy
+//!
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Util.h"
+#include "BVH.h"
+
+
+
+namespace World {
+
+	class Mesh {
+	private:
+		//! Compact geometry; positions are single precision regardless of Util::Real
+		std::vector<float> vertices;		// x, y, z per vertex
+		std::vector<uint32_t> indices;		// 3 vertex indices per triangle, in BVH leaf order
+
+		BVH bvh;							// Over the triangles of this mesh only
+		Util::AABB<double> bounds;
+
+	public:
+		//! Constructors
+		//! Takes ownership of the buffers and builds the hierarchy; indices must be in range
+		Mesh(std::vector<float>&& vertices, std::vector<uint32_t>&& indices);
+		Mesh(const Mesh&) = delete;
+		Mesh& operator=(const Mesh&) = delete;
+
+		//! Ray intersection; the mesh is treated as a two-sided surface without volume
+		int IntersectNearest(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real& tMax) const;
+		bool IntersectAny(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real tMax) const;
+		void IntersectPacketNearest(Util::RayPacket& packet, int* triangleIdx) const;
+
+		//! Accessors
+		int GetTriangleCount() const;
+		int GetVertexCount() const;
+		const Util::AABB<double>& GetBounds() const;
+		Util::Vector3<double> GetTriangleNormal(int triangleIdx) const;
+
+	private:
+		//! Helper functions
+		Util::Vector3<float> _GetVertex(uint32_t vertexIdx) const;
+	};
+
+}; // namespace World
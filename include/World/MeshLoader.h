@@ -0,0 +1,27 @@
+//!
+//! MeshLoader.h
+//! Streaming loader of triangle meshes from Wavefront OBJ and binary PLY files
+//!
+#pragma once
+
+#include <memory>
+#include <string>
+#include "Util.h"
+#include "Mesh.h"
+
+
+
+namespace World {
+
+	namespace MeshLoader {
+
+		//! Load
+		//! Loads the mesh at the given path, selecting the format by file extension (.obj or .ply)
+		//! Vertices are placed in world space by the transform as they are read
+		//! Returns nullptr on failure
+		//!
+		std::shared_ptr<Mesh> Load(const std::string& path, const Util::Transform& transform);
+
+	}; // namespace MeshLoader
+
+}; // namespace World
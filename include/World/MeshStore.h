@@ -0,0 +1,46 @@
+//!
+//! MeshStore.h
+//! Storage of triangle mesh references, each intersected through its own hierarchy
+//!
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Primitives.h"
+
+
+
+namespace World {
+
+	//! MeshStore
+	//! Mirrors the interface of PrimitiveStore for meshes. Each entry is a whole mesh, so the
+	//! world hierarchy culls meshes and every mesh then walks its own hierarchy over its triangles
+	//!
+	class MeshStore {
+	public:
+		using PrimitiveType = MeshRef;
+		static constexpr bool isBounded = true;
+		static constexpr int laneCount = 1;		// Meshes are visited one at a time
+
+	private:
+		std::vector<std::shared_ptr<const Mesh>> meshes;
+		std::vector<int> objectIdx;		// Owning world object of each mesh
+
+	public:
+		//! Interface functions
+		void Add(const MeshRef& meshRef, int objectIdx);
+		void Clear();
+		void Reorder(const std::vector<int>& order);
+
+		//! Intersection
+		int IntersectNearest(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real& tMax, int& faceIdx) const;
+		bool IntersectAny(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real tMax) const;
+		void IntersectPacketNearest(Util::RayPacket& packet, int first, int count, int* nearestIdx, int* faceIdx) const;
+
+		//! Accessors
+		int GetCount() const;
+		int GetObjectIndex(int meshIdx) const;
+		Util::AABB<Util::Real> GetBounds(int meshIdx) const;
+	};
+
+}; // namespace World
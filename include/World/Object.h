@@ -6,6 +6,7 @@
 
 #include "Util.h"
 #include "MaterialMgr.h"
+#include "Primitives.h"
 
 
 
@@ -13,11 +14,21 @@ namespace World {
 
 	//! ShapeType
 	//! Defines the shape of the object to render
+	//! Shapes are unit primitives placed by the object transform:
+	//!   SPHERE    - Radius 1, scaled by the largest scale component
+	//!   CUBE      - Side 1, scaled by the largest scale component
+	//!   RECTANGLE - Side 1, scaled per axis
+	//!   PLANE     - Infinite, facing up before rotation
+	//!   TRIANGLE  - Vertices (-0.5,-0.5,0), (0.5,-0.5,0), (0,0.5,0), scaled per axis
+	//!   MESH      - Loaded triangle mesh, placed by the loader (see MeshLoader)
 	//! 
 	enum class ShapeType {
 		CUBE,
 		RECTANGLE,
 		SPHERE,
+		PLANE,
+		TRIANGLE,
+		MESH,
 	};
 
 	class Object {
@@ -26,18 +37,30 @@ namespace World {
 		const MaterialMgr::Material& material;
 		Util::Transform transform;
 		ShapeType shape;
+		Primitive primitive;	// World space geometry derived from shape and transform
+		bool hasGeometry;		// False when the shape has no primitive to build; such objects are never added to a world
 
 	public:
 		//! Constructors
 		Object(MaterialMgr::MATERIAL_ID materialID, Util::Transform& transform, ShapeType shape);
+		Object(MaterialMgr::MATERIAL_ID materialID, Util::Transform& transform, std::shared_ptr<const Mesh> mesh);
 
 		//! Accessor/Mutator functions
+		MaterialMgr::MATERIAL_ID GetMaterialID() const;
 		const MaterialMgr::Material& GetMaterial() const;
 		const Util::Transform& GetTransform() const;
 		const Util::Vector3<double>& GetPosition() const;
 		const Util::Rotation& GetRotation() const;
 		const Util::Vector3<double>& GetScale() const;
 		ShapeType GetShapeType() const;
+		const Primitive& GetPrimitive() const;
+		bool HasGeometry() const;
+		Util::AABB<double> GetBounds() const;
+
+	private:
+		//! Helper functions
+		static Primitive _BuildPrimitive(ShapeType shape, const Util::Transform& transform);
+		static bool _HasUnitPrimitive(ShapeType shape);
 
 	};
 
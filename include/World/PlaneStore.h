@@ -0,0 +1,40 @@
+//!
+//! PlaneStore.h
+//! Packed structure-of-arrays storage of infinite plane primitives
+//!
+#pragma once
+
+#include "PrimitiveStore.h"
+
+
+
+namespace World {
+
+	struct PlaneLayout {
+		enum Field { POINT_X, POINT_Y, POINT_Z, NORMAL_X, NORMAL_Y, NORMAL_Z, FIELD_COUNT };
+	};
+
+	class PlaneStore : public PrimitiveStore<PlaneStore, PlaneLayout> {
+		friend class PrimitiveStore<PlaneStore, PlaneLayout>;
+
+	public:
+		using PrimitiveType = Plane;
+		static constexpr bool isBounded = false;	// Tested linearly rather than through a BVH
+
+		//! Interface functions
+		void Add(const Plane& plane, int objectIdx);
+
+	private:
+		//! Lane kernel
+		template <typename Fetch>
+		Lanes::Mask _IntersectLanes(const LaneRay& ray, Fetch&& fetch, Lanes& tNear, Lanes& tFar) const {
+			Lanes nx = fetch(NORMAL_X), ny = fetch(NORMAL_Y), nz = fetch(NORMAL_Z);
+			Lanes denom = (ray.dx * nx + ray.dy * ny) + ray.dz * nz;
+			Lanes numer = ((fetch(POINT_X) - ray.ox) * nx + (fetch(POINT_Y) - ray.oy) * ny) + (fetch(POINT_Z) - ray.oz) * nz;
+
+			tNear = tFar = numer / denom;
+			return tNear > Lanes(-INFINITY);	// Rejects NaN from padding and parallel rays
+		}
+	};
+
+}; // namespace World
@@ -0,0 +1,100 @@
+//!
+//! PrimitiveBucket.h
+//! Homogeneous batch of primitives of one type together with its acceleration structure
+//!
+#pragma once
+
+#include "BVH.h"
+
+
+
+namespace World {
+
+	template <typename Store>
+	class PrimitiveBucket {
+	private:
+		Store store;	// Kept in BVH leaf order
+		BVH bvh;		// Unused for unbounded primitive types
+
+		//! Internal variables
+		bool isDirty = false;	// Primitives changed since the last hierarchy build
+
+	public:
+		using PrimitiveType = typename Store::PrimitiveType;
+
+		//! Interface functions
+		void Add(const PrimitiveType& primitive, int objectIdx);
+		void Update();
+
+		template <typename LeafFn>
+		void Traverse(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real& tMax, LeafFn&& leafFn) const;
+		template <typename LeafFn>
+		void TraversePacket(Util::RayPacket& packet, LeafFn&& leafFn) const;
+
+		//! Accessors
+		const Store& GetStore() const { return store; }
+		const BVH& GetBVH() const { return bvh; }
+	};
+
+	//! Add
+	//! Appends a primitive owned by the given world object
+	//!
+	template <typename Store>
+	void PrimitiveBucket<Store>::Add(const PrimitiveType& primitive, int objectIdx) {
+		store.Add(primitive, objectIdx);
+		isDirty = true;
+	}
+
+	//! Update
+	//! Rebuilds the hierarchy if primitives have changed since the last build
+	//! Primitive storage is reordered to match the leaf order of the hierarchy
+	//!
+	template <typename Store>
+	void PrimitiveBucket<Store>::Update() {
+		if (!isDirty) {
+			return;
+		}
+
+		if constexpr (Store::isBounded) {
+			std::vector<Util::AABB<Util::Real>> bounds(store.GetCount());
+			for (int primI = 0; primI < store.GetCount(); primI++) {
+				bounds[primI] = store.GetBounds(primI);
+			}
+
+			bvh.Build(bounds, Store::laneCount);
+			store.Reorder(bvh.GetPrimitiveIndices());
+		}
+		isDirty = false;
+	}
+
+	//! Traverse
+	//! Invokes leafFn(first, count) for every batch of primitives the ray may collide with before tMax
+	//! See BVH::Traverse. Unbounded primitives form a single batch
+	//!
+	template <typename Store>
+	template <typename LeafFn>
+	void PrimitiveBucket<Store>::Traverse(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real& tMax, LeafFn&& leafFn) const {
+		if constexpr (Store::isBounded) {
+			bvh.Traverse(origin, direction, tMax, leafFn);
+		}
+		else if (store.GetCount() > 0) {
+			leafFn(0, store.GetCount());
+		}
+	}
+
+	//! TraversePacket
+	//! Invokes leafFn(first, count) for every batch of primitives any ray of the packet may collide with
+	//! See BVH::TraversePacket. Unbounded primitives form a single batch
+	//!
+	template <typename Store>
+	template <typename LeafFn>
+	void PrimitiveBucket<Store>::TraversePacket(Util::RayPacket& packet, LeafFn&& leafFn) const {
+		if constexpr (Store::isBounded) {
+			bvh.TraversePacket(packet, leafFn);
+		}
+		else if (store.GetCount() > 0) {
+			leafFn(0, store.GetCount());
+		}
+	}
+
+}; // namespace World
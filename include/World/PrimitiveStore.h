@@ -0,0 +1,239 @@
+//!
+//! PrimitiveStore.h
+//! Packed structure-of-arrays storage of a single primitive type with batched intersection kernels
+//!
+#pragma once
+
+#include <vector>
+#include "Util.h"
+#include "Primitives.h"
+
+
+
+namespace World {
+
+	using Lanes = Util::Simd<Util::Real>;
+
+	//! LaneRay
+	//! Ray components broadcast or gathered across the lanes of a kernel iteration
+	//!
+	struct LaneRay {
+		Lanes ox, oy, oz;
+		Lanes dx, dy, dz;
+	};
+
+	//! PrimitiveStore
+	//! Shared storage and kernel loops for one primitive type. Derived stores describe their
+	//! attribute arrays through Layout::Field/FIELD_COUNT and implement
+	//!
+	//!   Lanes::Mask _IntersectLanes(const LaneRay& ray, Fetch&& fetch, Lanes& tNear, Lanes& tFar) const
+	//!
+	//! which intersects the ray lanes with the primitive lanes, where fetch(field) returns the lanes of
+	//! the given attribute. The entry and exit distances are only meaningful in lanes of the returned mask
+	//!
+	template <typename Derived, typename Layout>
+	class PrimitiveStore : public Layout {
+	public:
+		//! Number of primitives tested per kernel iteration
+		static constexpr int laneCount = Lanes::width;
+
+	protected:
+		//! Primitive attributes, padded such that a full lane load starting at any primitive stays in bounds
+		Util::AlignedVector<Util::Real> fields[Layout::FIELD_COUNT];
+		std::vector<int> objectIdx;		// Owning world object of each primitive
+
+		int count = 0;
+
+	public:
+		//! Interface functions
+		void Clear();
+		void Reorder(const std::vector<int>& order);
+
+		//! Batched intersection
+		int IntersectNearest(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real& tMax, int& faceIdx) const;
+		bool IntersectAny(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real tMax) const;
+		void IntersectPacketNearest(Util::RayPacket& packet, int first, int count, int* nearestIdx, int* faceIdx) const;
+
+		//! Accessors
+		int GetCount() const { return count; }
+		int GetObjectIndex(int primIdx) const { return objectIdx[primIdx]; }
+
+	protected:
+		//! Helper functions
+		void _Append(const Util::Real (&values)[Layout::FIELD_COUNT], int objectIdx);
+		void _Pad();
+	};
+
+	//! Clear
+	//! Removes all primitives
+	//!
+	template <typename Derived, typename Layout>
+	void PrimitiveStore<Derived, Layout>::Clear() {
+		for (Util::AlignedVector<Util::Real>& field : fields) {
+			field.clear();
+		}
+		objectIdx.clear();
+		count = 0;
+	}
+
+	//! Reorder
+	//! Permutes the primitives such that primitive i becomes the primitive previously at order[i]
+	//!
+	template <typename Derived, typename Layout>
+	void PrimitiveStore<Derived, Layout>::Reorder(const std::vector<int>& order) {
+		if (order.size() != count) {
+			LOG_ERROR("PrimitiveStore: Reorder size does not match primitive count");
+			return;
+		}
+
+		for (Util::AlignedVector<Util::Real>& field : fields) {
+			Util::AlignedVector<Util::Real> reordered(count);
+			for (int primI = 0; primI < count; primI++) {
+				reordered[primI] = field[order[primI]];
+			}
+			field.swap(reordered);
+		}
+
+		std::vector<int> newObjectIdx(count);
+		for (int primI = 0; primI < count; primI++) {
+			newObjectIdx[primI] = objectIdx[order[primI]];
+		}
+		objectIdx.swap(newObjectIdx);
+
+		_Pad();
+	}
+
+	//! IntersectNearest
+	//! Tests the primitives in [first, first + count) against the ray, laneCount primitives at a time
+	//! Returns the index of the nearest primitive hit closer than tMax and shrinks tMax to its distance,
+	//! or -1 if none is hit. A ray starting inside a primitive collides with its far side
+	//! Primitives of a store have a single face, so faceIdx is set to -1 on a hit
+	//!
+	template <typename Derived, typename Layout>
+	int PrimitiveStore<Derived, Layout>::IntersectNearest(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real& tMax, int& faceIdx) const {
+		int nearestIdx = -1;
+		int end = first + count;
+
+		const LaneRay ray = { Lanes(origin.x), Lanes(origin.y), Lanes(origin.z), Lanes(direction.x), Lanes(direction.y), Lanes(direction.z) };
+		const Lanes zero(0), minDist(Util::collisionEpsilon<Util::Real>), inf(INFINITY);
+
+		for (int primI = first; primI < end; primI += laneCount) {
+			Lanes tNear, tFar;
+			Lanes::Mask hit = static_cast<const Derived*>(this)->_IntersectLanes(ray, [&](int field) { return Lanes::Load(&fields[field][primI]); }, tNear, tFar);
+
+			//! Smallest positive distance per lane
+			Lanes dist = Select(tNear > zero, tNear, Select(tFar > zero, tFar, inf));
+
+			int laneMask = (hit & Lanes::FirstLanes(end - primI) & (dist >= minDist) & (dist < Lanes(tMax))).Bits();
+			if (laneMask == 0) {
+				continue;
+			}
+
+			//! Resolve the nearest lane in primitive order
+			alignas(32) Util::Real dists[laneCount];
+			dist.StoreAligned(dists);
+			for (int lane = 0; lane < laneCount; lane++) {
+				if ((laneMask & (1 << lane)) && dists[lane] < tMax) {
+					tMax = dists[lane];
+					nearestIdx = primI + lane;
+				}
+			}
+		}
+
+		if (nearestIdx != -1) {
+			faceIdx = -1;
+		}
+		return nearestIdx;
+	}
+
+	//! IntersectAny
+	//! Returns whether the ray collides with any primitive in [first, first + count) within (0, tMax)
+	//!
+	template <typename Derived, typename Layout>
+	bool PrimitiveStore<Derived, Layout>::IntersectAny(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real tMax) const {
+		int end = first + count;
+
+		const LaneRay ray = { Lanes(origin.x), Lanes(origin.y), Lanes(origin.z), Lanes(direction.x), Lanes(direction.y), Lanes(direction.z) };
+		const Lanes minDist(Util::collisionEpsilon<Util::Real>), maxDist(tMax);
+
+		for (int primI = first; primI < end; primI += laneCount) {
+			Lanes tNear, tFar;
+			Lanes::Mask hit = static_cast<const Derived*>(this)->_IntersectLanes(ray, [&](int field) { return Lanes::Load(&fields[field][primI]); }, tNear, tFar);
+
+			//! Either surface crossing within range blocks the ray
+			Lanes::Mask inRange = ((tNear >= minDist) & (tNear < maxDist)) | ((tFar >= minDist) & (tFar < maxDist));
+			if ((hit & inRange & Lanes::FirstLanes(end - primI)).Bits() != 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//! IntersectPacketNearest
+	//! Tests every ray of the packet against the primitives in [first, first + count), laneCount rays at a time
+	//! Rays that find a closer primitive have their tMax shrunk, nearestIdx set to the primitive index and
+	//! faceIdx set to -1. The packet must be padded to a multiple of laneCount
+	//!
+	template <typename Derived, typename Layout>
+	void PrimitiveStore<Derived, Layout>::IntersectPacketNearest(Util::RayPacket& packet, int first, int count, int* nearestIdx, int* faceIdx) const {
+		int end = first + count;
+		const Lanes zero(0), minDist(Util::collisionEpsilon<Util::Real>), inf(INFINITY);
+
+		for (int rayI = 0; rayI < packet.count; rayI += laneCount) {
+			//! Keep the ray group resident while sweeping the primitives
+			const LaneRay ray = {
+				Lanes::LoadAligned(&packet.originX[rayI]), Lanes::LoadAligned(&packet.originY[rayI]), Lanes::LoadAligned(&packet.originZ[rayI]),
+				Lanes::LoadAligned(&packet.dirX[rayI]), Lanes::LoadAligned(&packet.dirY[rayI]), Lanes::LoadAligned(&packet.dirZ[rayI])
+			};
+			Lanes tMax = Lanes::LoadAligned(&packet.tMax[rayI]);
+
+			for (int primI = first; primI < end; primI++) {
+				Lanes tNear, tFar;
+				Lanes::Mask hit = static_cast<const Derived*>(this)->_IntersectLanes(ray, [&](int field) { return Lanes(fields[field][primI]); }, tNear, tFar);
+
+				Lanes dist = Select(tNear > zero, tNear, Select(tFar > zero, tFar, inf));
+				Lanes::Mask valid = hit & (dist >= minDist) & (dist < tMax);
+				tMax = Select(valid, dist, tMax);
+
+				//! Record the primitive for rays it is now nearest to; padding rays are never valid
+				int laneMask = valid.Bits();
+				for (int lane = 0; lane < laneCount; lane++) {
+					if (laneMask & (1 << lane)) {
+						nearestIdx[rayI + lane] = primI;
+						faceIdx[rayI + lane] = -1;
+					}
+				}
+			}
+
+			tMax.StoreAligned(&packet.tMax[rayI]);
+		}
+	}
+
+	//! _Append
+	//! Appends a primitive with the given attribute values, owned by the given world object
+	//!
+	template <typename Derived, typename Layout>
+	void PrimitiveStore<Derived, Layout>::_Append(const Util::Real (&values)[Layout::FIELD_COUNT], int objectIdx) {
+		for (int fieldI = 0; fieldI < Layout::FIELD_COUNT; fieldI++) {
+			fields[fieldI].resize(count);	// Drop padding before appending
+			fields[fieldI].push_back(values[fieldI]);
+		}
+		this->objectIdx.push_back(objectIdx);
+		count++;
+
+		_Pad();
+	}
+
+	//! _Pad
+	//! Extends the arrays so that a full lane load starting at any primitive stays in bounds
+	//! Padding primitives have NaN attributes, which never satisfy any collision comparison
+	//!
+	template <typename Derived, typename Layout>
+	void PrimitiveStore<Derived, Layout>::_Pad() {
+		for (Util::AlignedVector<Util::Real>& field : fields) {
+			field.resize(count + laneCount - 1, NAN);
+		}
+	}
+
+}; // namespace World
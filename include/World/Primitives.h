@@ -0,0 +1,228 @@
+//!
+//! Primitives.h
+//! World space geometric primitives and their scalar intersection routines
+//!
+#pragma once
+
+#include <memory>
+#include <variant>
+#include "Util.h"
+#include "Mesh.h"
+
+
+
+namespace World {
+
+	struct Sphere {
+		Util::Vector3<double> center;
+		double radius;
+	};
+
+	//! Infinite two-sided plane through point
+	struct Plane {
+		Util::Vector3<double> point;
+		Util::Vector3<double> normal;
+	};
+
+	//! Oriented box; axes are orthonormal
+	struct Box {
+		Util::Vector3<double> center;
+		Util::Vector3<double> halfExtent;	// Along each of the box axes
+		Util::Vector3<double> axes[3];
+	};
+
+	//! Two-sided triangle
+	struct Triangle {
+		Util::Vector3<double> v0;
+		Util::Vector3<double> v1;
+		Util::Vector3<double> v2;
+	};
+
+	//! Shared triangle mesh, already placed in world space; two-sided and without volume
+	struct MeshRef {
+		std::shared_ptr<const Mesh> mesh;
+	};
+
+	//! Primitive
+	//! Geometry of an object; routines over it are selected at compile time through std::visit
+	//!
+	using Primitive = std::variant<Sphere, Plane, Box, Triangle, MeshRef>;
+
+	/* ----------------------------------------------------------------
+	 * Ray intersection
+	 * Returns whether the ray line collides, storing the entry and exit distances
+	 * Distances may be negative for collisions behind the ray origin
+	 * ---------------------------------------------------------------- */
+	template <typename T>
+	bool IntersectPrimitive(const Sphere& sphere, const Util::Vector3<T>& origin, const Util::Vector3<T>& direction, T& tNear, T& tFar) {
+		Util::Vector3<T> offsetRayOrigin = origin - Util::Vector3<T>(sphere.center);	// Offset ray as if sphere was at (0,0,0)
+		T radius = (T)sphere.radius;
+
+		// sqrLength(rayOrigin + rayDir * distance) = r^2
+		//
+		T a = direction.Dot(direction);	// Should be 1
+		T b = 2 * offsetRayOrigin.Dot(direction);
+		T c = offsetRayOrigin.Dot(offsetRayOrigin) - radius * radius;
+
+		T discriminant = (b * b) - (4 * a * c);
+		if (discriminant < 0) {
+			return false;	// Miss
+		}
+
+		tNear = (-b - std::sqrt(discriminant)) / (2 * a);
+		tFar = (-b + std::sqrt(discriminant)) / (2 * a);
+		return true;
+	}
+
+	template <typename T>
+	bool IntersectPrimitive(const Plane& plane, const Util::Vector3<T>& origin, const Util::Vector3<T>& direction, T& tNear, T& tFar) {
+		Util::Vector3<T> normal(plane.normal);
+		T denom = direction.Dot(normal);
+		if (denom == 0) {
+			return false;	// Parallel
+		}
+
+		tNear = tFar = (Util::Vector3<T>(plane.point) - origin).Dot(normal) / denom;
+		return true;
+	}
+
+	template <typename T>
+	bool IntersectPrimitive(const Box& box, const Util::Vector3<T>& origin, const Util::Vector3<T>& direction, T& tNear, T& tFar) {
+		Util::Vector3<T> offsetRayOrigin = origin - Util::Vector3<T>(box.center);
+		tNear = -INFINITY;
+		tFar = INFINITY;
+
+		//! Slab test in the box frame
+		for (int axis = 0; axis < 3; axis++) {
+			Util::Vector3<T> boxAxis(box.axes[axis]);
+			T localOrigin = offsetRayOrigin.Dot(boxAxis);
+			T invDir = 1 / direction.Dot(boxAxis);
+			T halfExtent = (T)box.halfExtent[axis];
+
+			T t1 = (-halfExtent - localOrigin) * invDir;
+			T t2 = (halfExtent - localOrigin) * invDir;
+			tNear = std::max(tNear, std::min(t1, t2));
+			tFar = std::min(tFar, std::max(t1, t2));
+		}
+
+		return tFar >= tNear;
+	}
+
+	template <typename T>
+	bool IntersectPrimitive(const Triangle& triangle, const Util::Vector3<T>& origin, const Util::Vector3<T>& direction, T& tNear, T& tFar) {
+		//! Moller-Trumbore
+		Util::Vector3<T> v0(triangle.v0);
+		Util::Vector3<T> edge1 = Util::Vector3<T>(triangle.v1) - v0;
+		Util::Vector3<T> edge2 = Util::Vector3<T>(triangle.v2) - v0;
+
+		Util::Vector3<T> p = direction.Cross(edge2);
+		T det = edge1.Dot(p);
+		if (det == 0) {
+			return false;	// Parallel
+		}
+
+		T invDet = 1 / det;
+		Util::Vector3<T> s = origin - v0;
+		T u = s.Dot(p) * invDet;
+		if (u < 0 || u > 1) {
+			return false;
+		}
+
+		Util::Vector3<T> q = s.Cross(edge1);
+		T v = direction.Dot(q) * invDet;
+		if (v < 0 || u + v > 1) {
+			return false;
+		}
+
+		tNear = tFar = edge2.Dot(q) * invDet;
+		return true;
+	}
+
+	template <typename T>
+	bool IntersectPrimitive(const MeshRef& meshRef, const Util::Vector3<T>& origin, const Util::Vector3<T>& direction, T& tNear, T& tFar) {
+		//! Only the nearest triangle in front of the origin is reported
+		Util::Real tMax = INFINITY;
+		if (meshRef.mesh->IntersectNearest(Util::Vector3<Util::Real>(origin), Util::Vector3<Util::Real>(direction), tMax) == -1) {
+			return false;
+		}
+
+		tNear = tFar = (T)tMax;
+		return true;
+	}
+
+	template <typename T>
+	bool IntersectPrimitive(const Primitive& primitive, const Util::Vector3<T>& origin, const Util::Vector3<T>& direction, T& tNear, T& tFar) {
+		return std::visit([&](const auto& prim) { return IntersectPrimitive(prim, origin, direction, tNear, tFar); }, primitive);
+	}
+
+	/* ----------------------------------------------------------------
+	 * Surface normals
+	 * Returns the outward normal at a position on the surface. Two-sided
+	 * primitives return the side facing against the given direction.
+	 * faceIdx is the face reported by the nearest collision query, which
+	 * only primitives made of several separately stored faces use
+	 * ---------------------------------------------------------------- */
+	template <typename T>
+	Util::Vector3<T> GetSurfaceNormal(const Sphere& sphere, const Util::Vector3<T>& position, const Util::Vector3<T>& /*direction*/, int /*faceIdx*/) {
+		return (position - Util::Vector3<T>(sphere.center)).Normalized();
+	}
+
+	template <typename T>
+	Util::Vector3<T> GetSurfaceNormal(const Plane& plane, const Util::Vector3<T>& /*position*/, const Util::Vector3<T>& direction, int /*faceIdx*/) {
+		Util::Vector3<T> normal(plane.normal);
+		return (normal.Dot(direction) > 0) ? normal.Reversed() : normal;
+	}
+
+	template <typename T>
+	Util::Vector3<T> GetSurfaceNormal(const Box& box, const Util::Vector3<T>& position, const Util::Vector3<T>& /*direction*/, int /*faceIdx*/) {
+		//! Face whose slab the position lies furthest across, relative to its extent
+		Util::Vector3<T> offset = position - Util::Vector3<T>(box.center);
+		int faceAxis = 0;
+		T faceDist = 0;
+		T faceSign = 1;
+		for (int axis = 0; axis < 3; axis++) {
+			T local = offset.Dot(Util::Vector3<T>(box.axes[axis])) / (T)box.halfExtent[axis];
+			if (std::abs(local) > faceDist) {
+				faceAxis = axis;
+				faceDist = std::abs(local);
+				faceSign = (local < 0) ? -1 : 1;
+			}
+		}
+		return Util::Vector3<T>(box.axes[faceAxis]) * faceSign;
+	}
+
+	template <typename T>
+	Util::Vector3<T> GetSurfaceNormal(const Triangle& triangle, const Util::Vector3<T>& /*position*/, const Util::Vector3<T>& direction, int /*faceIdx*/) {
+		Util::Vector3<T> v0(triangle.v0);
+		Util::Vector3<T> normal = (Util::Vector3<T>(triangle.v1) - v0).Cross(Util::Vector3<T>(triangle.v2) - v0).Normalized();
+		return (normal.Dot(direction) > 0) ? normal.Reversed() : normal;
+	}
+
+	//! The face is the index of the triangle hit within the mesh
+	template <typename T>
+	Util::Vector3<T> GetSurfaceNormal(const MeshRef& meshRef, const Util::Vector3<T>& /*position*/, const Util::Vector3<T>& direction, int faceIdx) {
+		Util::Vector3<T> normal(meshRef.mesh->GetTriangleNormal(faceIdx));
+		return (normal.Dot(direction) > 0) ? normal.Reversed() : normal;
+	}
+
+	template <typename T>
+	Util::Vector3<T> GetSurfaceNormal(const Primitive& primitive, const Util::Vector3<T>& position, const Util::Vector3<T>& direction, int faceIdx) {
+		return std::visit([&](const auto& prim) { return GetSurfaceNormal(prim, position, direction, faceIdx); }, primitive);
+	}
+
+	/* ----------------------------------------------------------------
+	 * Properties
+	 * ---------------------------------------------------------------- */
+	bool HasVolume(const Primitive& primitive);
+
+	/* ----------------------------------------------------------------
+	 * Bounds
+	 * ---------------------------------------------------------------- */
+	Util::AABB<double> GetBounds(const Sphere& sphere);
+	Util::AABB<double> GetBounds(const Plane& plane);
+	Util::AABB<double> GetBounds(const Box& box);
+	Util::AABB<double> GetBounds(const Triangle& triangle);
+	Util::AABB<double> GetBounds(const MeshRef& meshRef);
+	Util::AABB<double> GetBounds(const Primitive& primitive);
+
+}; // namespace World
@@ -0,0 +1,56 @@
+//!
+//! SphereStore.h
+//! Packed structure-of-arrays storage of sphere primitives
+//!
+#pragma once
+
+#include "PrimitiveStore.h"
+
+
+
+namespace World {
+
+	struct SphereLayout {
+		enum Field { CENTER_X, CENTER_Y, CENTER_Z, RADIUS, FIELD_COUNT };
+	};
+
+	class SphereStore : public PrimitiveStore<SphereStore, SphereLayout> {
+		friend class PrimitiveStore<SphereStore, SphereLayout>;
+
+	public:
+		using PrimitiveType = Sphere;
+		static constexpr bool isBounded = true;
+
+		//! Interface functions
+		void Add(const Sphere& sphere, int objectIdx);
+
+		//! Accessors
+		Util::AABB<Util::Real> GetBounds(int sphereIdx) const;
+
+	private:
+		//! Lane kernel
+		template <typename Fetch>
+		Lanes::Mask _IntersectLanes(const LaneRay& ray, Fetch&& fetch, Lanes& tNear, Lanes& tFar) const {
+			//! Offset ray as if each sphere was at (0,0,0)
+			Lanes ocx = ray.ox - fetch(CENTER_X);
+			Lanes ocy = ray.oy - fetch(CENTER_Y);
+			Lanes ocz = ray.oz - fetch(CENTER_Z);
+			Lanes r = fetch(RADIUS);
+
+			// sqrLength(rayOrigin + rayDir * distance) = r^2
+			Lanes a = (ray.dx * ray.dx + ray.dy * ray.dy) + ray.dz * ray.dz;	// Should be 1
+			Lanes b = Lanes(2) * ((ocx * ray.dx + ocy * ray.dy) + ocz * ray.dz);
+			Lanes c = ((ocx * ocx + ocy * ocy) + ocz * ocz) - r * r;
+			Lanes discriminant = b * b - (Lanes(4) * a) * c;
+
+			//! Roots; lanes with a negative discriminant produce NaN and are masked out
+			Lanes sqrtDisc = Sqrt(discriminant);
+			Lanes negB = Lanes(0) - b;
+			Lanes twoA = Lanes(2) * a;
+			tNear = (negB - sqrtDisc) / twoA;
+			tFar = (negB + sqrtDisc) / twoA;
+			return discriminant >= Lanes(0);
+		}
+	};
+
+}; // namespace World
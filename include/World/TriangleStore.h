@@ -0,0 +1,76 @@
+//!
+//! TriangleStore.h
+//! Packed structure-of-arrays storage of triangle primitives
+//!
+#pragma once
+
+#include "PrimitiveStore.h"
+
+
+
+namespace World {
+
+	struct TriangleLayout {
+		enum Field {
+			V0_X, V0_Y, V0_Z,
+			EDGE1_X, EDGE1_Y, EDGE1_Z,	// v1 - v0
+			EDGE2_X, EDGE2_Y, EDGE2_Z,	// v2 - v0
+			FIELD_COUNT
+		};
+	};
+
+	class TriangleStore : public PrimitiveStore<TriangleStore, TriangleLayout> {
+		friend class PrimitiveStore<TriangleStore, TriangleLayout>;
+
+	public:
+		using PrimitiveType = Triangle;
+		static constexpr bool isBounded = true;
+
+		//! Interface functions
+		void Add(const Triangle& triangle, int objectIdx);
+
+		//! Accessors
+		Util::AABB<Util::Real> GetBounds(int triangleIdx) const;
+
+		//! IntersectLanes
+		//! Moller-Trumbore over lanes of triangles given by v0 and the edges v1 - v0, v2 - v0
+		//! Shared with the triangle mesh leaf kernel
+		//!
+		static Lanes::Mask IntersectLanes(const LaneRay& ray, const Lanes (&v0)[3], const Lanes (&edge1)[3], const Lanes (&edge2)[3], Lanes& tNear, Lanes& tFar) {
+			const Lanes &e1x = edge1[0], &e1y = edge1[1], &e1z = edge1[2];
+			const Lanes &e2x = edge2[0], &e2y = edge2[1], &e2z = edge2[2];
+
+			//! p = direction x edge2
+			Lanes px = ray.dy * e2z - ray.dz * e2y;
+			Lanes py = ray.dz * e2x - ray.dx * e2z;
+			Lanes pz = ray.dx * e2y - ray.dy * e2x;
+			Lanes invDet = Lanes(1) / ((e1x * px + e1y * py) + e1z * pz);	// Parallel rays produce inf/NaN and fail below
+
+			//! Barycentric u
+			Lanes sx = ray.ox - v0[0];
+			Lanes sy = ray.oy - v0[1];
+			Lanes sz = ray.oz - v0[2];
+			Lanes u = ((sx * px + sy * py) + sz * pz) * invDet;
+
+			//! Barycentric v via q = s x edge1
+			Lanes qx = sy * e1z - sz * e1y;
+			Lanes qy = sz * e1x - sx * e1z;
+			Lanes qz = sx * e1y - sy * e1x;
+			Lanes v = ((ray.dx * qx + ray.dy * qy) + ray.dz * qz) * invDet;
+
+			tNear = tFar = ((e2x * qx + e2y * qy) + e2z * qz) * invDet;
+			return (u >= Lanes(0)) & (v >= Lanes(0)) & (u + v <= Lanes(1));
+		}
+
+	private:
+		//! Lane kernel
+		template <typename Fetch>
+		Lanes::Mask _IntersectLanes(const LaneRay& ray, Fetch&& fetch, Lanes& tNear, Lanes& tFar) const {
+			const Lanes v0[3] = { fetch(V0_X), fetch(V0_Y), fetch(V0_Z) };
+			const Lanes edge1[3] = { fetch(EDGE1_X), fetch(EDGE1_Y), fetch(EDGE1_Z) };
+			const Lanes edge2[3] = { fetch(EDGE2_X), fetch(EDGE2_Y), fetch(EDGE2_Z) };
+			return IntersectLanes(ray, v0, edge1, edge2, tNear, tFar);
+		}
+	};
+
+}; // namespace World
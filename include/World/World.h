@@ -4,23 +4,58 @@
 //! 
 #pragma once
 
+#include <cstdint>
+#include <tuple>
 #include <vector>
 #include "Object.h"
+#include "PrimitiveBucket.h"
+#include "SphereStore.h"
+#include "BoxStore.h"
+#include "TriangleStore.h"
+#include "PlaneStore.h"
+#include "MeshStore.h"
 
 
 
 namespace World {
 
+	//! PrimitiveBuckets
+	//! One bucket per primitive type, so that each intersection kernel runs over a homogeneous batch
+	//! 
+	using PrimitiveBuckets = std::tuple<
+		PrimitiveBucket<SphereStore>,
+		PrimitiveBucket<BoxStore>,
+		PrimitiveBucket<TriangleStore>,
+		PrimitiveBucket<PlaneStore>,
+		PrimitiveBucket<MeshStore>>;
+
 	class World {
 	private:
 		std::vector<Object> objects;
+		PrimitiveBuckets buckets;	// Packed primitives of all objects
+		uint64_t version = 0;		// Incremented whenever the rendered contents change
 
 	public:
 		int GetObjectCount() const;
+		uint64_t GetVersion() const;
 		Object* GetObject(int index);
 		const Object* GetObject(int index) const;
-		void AddObject(Object& obj);
+		bool AddObject(Object& obj);
+
+		//! Acceleration structure
+		void UpdateBVH();
+
+		template <typename Fn>
+		void ForEachBucket(Fn&& fn) const;
 
 	};
 
-}; // namespace World
\ No newline at end of file
+	//! ForEachBucket
+	//! Invokes fn(bucket) on every primitive bucket, with the bucket type known at compile time
+	//! 
+	template <typename Fn>
+	void World::ForEachBucket(Fn&& fn) const {
+		std::apply([&](const auto&... bucket) { (fn(bucket), ...); }, buckets);
+	}
+
+}; // namespace World
@@ -3,6 +3,8 @@
 //! Manages the raytracing engine
 //! 
 #include "Engine.h"
+#include "MeshLoader.h"
+#include "FrameWriter.h"
 
 // TODO: Make this configurable
 //#define SINGLE_THREADED
@@ -13,9 +15,11 @@ namespace Engine {
 
 	//! Constructor
 	//! 
-	Engine::Engine(int nRenderThreads)
+	Engine::Engine(int nRenderThreads, bool pinRenderThreads, bool isHeadless)
 		: isActive(false)
 		, nRenderThreads(nRenderThreads)
+		, pinRenderThreads(pinRenderThreads)
+		, isHeadless(isHeadless)
 		, renderPool("RenderPool", nRenderThreads)
 	{}
 
@@ -36,7 +40,7 @@ namespace Engine {
 		camera = std::make_unique<Player::Camera>(startPos, startRot, fov);
 		player = std::make_shared<Player::Player>(std::move(camera));
 		inputMgr = std::make_unique<InputMgr::InputMgr>(player, world);
-		renderer = std::make_unique<Renderer::Renderer>(windowTitle, screenWidth, screenHeight, player, world, inputMgr);
+		renderer = std::make_unique<Renderer::Renderer>(windowTitle, screenWidth, screenHeight, player, world, inputMgr, isHeadless);
 
 		/* ----------------------------------------------------------------
 		* Add world objects
@@ -71,7 +75,7 @@ namespace Engine {
 		* ---------------------------------------------------------------- */
 		bool success = renderer->Init();
 		if (!success) {
-			Util::Log::Error("Engine: Failed to initialize renderer");
+			LOG_ERROR("Engine: Failed to initialize renderer");
 			return false;
 		}
 
@@ -79,13 +83,107 @@ namespace Engine {
 		/* ----------------------------------------------------------------
 		* Initialize render pool
 		* ---------------------------------------------------------------- */
-		renderPool.Init();
+		renderPool.Init(pinRenderThreads);
+		_BuildFrameGraph();
 #endif
 
 		isActive = true;
 		return true;
 	}
 
+	//! AddMesh
+	//! Loads a triangle mesh from an OBJ or binary PLY file and adds it to the world at the given transform
+	//! 
+	bool Engine::AddMesh(const std::string& path, MaterialMgr::MATERIAL_ID materialID, Util::Transform& transform) {
+		if (world == nullptr) {
+			LOG_ERROR("Engine: Attempted to add a mesh before initialization");
+			return false;
+		}
+
+		std::shared_ptr<World::Mesh> mesh = World::MeshLoader::Load(path, transform);
+		if (mesh == nullptr) {
+			LOG_ERROR("Engine: Failed to load mesh " + path);
+			return false;
+		}
+
+		World::Object obj(materialID, transform, std::move(mesh));
+		return world->AddObject(obj);
+	}
+
+	//! SetTileSize
+	//! Sets the edge length in pixels of the square tiles a frame is rendered in
+	//! 
+	bool Engine::SetTileSize(int tileSize) {
+		if (renderer == nullptr) {
+			LOG_ERROR("Engine: Attempted to set the tile size before initialization");
+			return false;
+		}
+
+		renderer->SetTileSize(tileSize);
+		return renderer->GetTileSize() == tileSize;
+	}
+
+	//! SetFrameTimeBudget
+	//! Sets the frame time in seconds to maintain by lowering the render resolution. 0 always renders at the window size
+	//! 
+	void Engine::SetFrameTimeBudget(double seconds) {
+		resolutionScaler.SetFrameTimeBudget(seconds);
+	}
+
+	//! SetFrameDeadline
+	//! Bounds the time each frame may render for in seconds. Tiles are then issued center first, and tiles not
+	//! started in time show the previous frame instead. 0 renders every tile
+	//! 
+	bool Engine::SetFrameDeadline(double seconds) {
+		if (renderer == nullptr) {
+			LOG_ERROR("Engine: Attempted to set the frame deadline before initialization");
+			return false;
+		}
+
+		this->frameDeadline = std::max(0.0, seconds);
+		renderer->SetTileOrder(frameDeadline > 0 ? Renderer::TileOrder::CENTER_FIRST : Renderer::TileOrder::COST);
+		return true;
+	}
+
+	//! SetTonemapSettings
+	//! Sets how the linear radiance of frames is mapped to display pixels
+	//! 
+	bool Engine::SetTonemapSettings(const Renderer::TonemapSettings& settings) {
+		if (renderer == nullptr) {
+			LOG_ERROR("Engine: Attempted to set the tonemapping before initialization");
+			return false;
+		}
+
+		renderer->SetTonemapSettings(settings);
+		return true;
+	}
+
+	//! SetProgressive
+	//! Sets whether frames are averaged while the camera and world stay unchanged, converging to an anti-aliased image
+	//! 
+	bool Engine::SetProgressive(bool isProgressive) {
+		if (renderer == nullptr) {
+			LOG_ERROR("Engine: Attempted to set progressive rendering before initialization");
+			return false;
+		}
+
+		renderer->SetProgressive(isProgressive);
+		return true;
+	}
+
+	//! SaveFrame
+	//! Writes the most recently completed frame to the given path as PPM, PNG or PFM, by extension
+	//! PFM keeps the linear radiance of the frame, before tonemapping
+	//! 
+	bool Engine::SaveFrame(const std::string& path) {
+		if (renderer == nullptr) {
+			LOG_ERROR("Engine: Attempted to save a frame before initialization");
+			return false;
+		}
+
+		return Renderer::FrameWriter::Write(*renderer->GetRawFrame(), path, renderer->GetRawHdrFrame());
+	}
+
 	//! IsActive
 	//! Returns whether the engine is in an initialized and active state
 	//! 
@@ -93,53 +191,101 @@ namespace Engine {
 		return this->isActive;
 	}
 
-	//! ProduceFrame
-	//! Produces and displays a frame in the display window
+	//! DisplayFrame
+	//! Renders the next frame on the render pool while the previously completed frame is displayed
 	//! 
 	bool Engine::DisplayFrame() {
 		if (!IsActive()) {
-			Util::Log::Error("Engine: Attempted to produce a frame when in an inactive state");
+			LOG_ERROR("Engine: Attempted to produce a frame when in an inactive state");
 			return false;
 		}
 
 		//! Check for renderer activity
 		if (!renderer->IsActive()) {
-			Util::Log::Info("Engine: Renderer has been shut down");
+			LOG_INFO("Engine: Renderer has been shut down");
 			this->isActive = false;
 			return false;
 		}
 
+		//! Rebuild acceleration structures for any world changes
+		world->UpdateBVH();
+
+		//! Size the next frame from the period of the frame loop
+		auto frameTime = std::chrono::steady_clock::now();
+		if (lastFrameTime.time_since_epoch().count() != 0) {
+			resolutionScaler.AddFrameTime(std::chrono::duration<double>(frameTime - lastFrameTime).count());
+		}
+		lastFrameTime = frameTime;
+		renderer->SetRenderScale(resolutionScaler.GetScale());
+
 		/* ----------------------------------------------------------------
 		* Generate world frame
 		* ---------------------------------------------------------------- */
 #ifdef SINGLE_THREADED
 		renderer->ProduceWorldFrame(player);
+		renderer->DisplayFrame();
 		
 #else
-		//! Get rays to trace
-		std::vector<Renderer::RayMgr::Ray> rays = renderer->GenerateRays(player.get()->GetCamera(), renderer->GetWindowWidth(), renderer->GetWindowHeight());
-
-		//! Split into rendering tasks
-		constexpr int nRaysPerTask = 1000;
-		int nTasks = std::ceil(rays.size() / (double)nRaysPerTask);
-		std::vector<Util::RenderTask> tasks(nTasks); // TODO: Do not create space every frame
-
-		for (int taskI = 0; taskI < tasks.size(); taskI++) {
-			tasks[taskI].startIdx = taskI * nRaysPerTask;
-			tasks[taskI].endIdx = std::min(tasks[taskI].startIdx + nRaysPerTask, (int)rays.size());
-			tasks[taskI].rays = &rays;
-			tasks[taskI].renderer = renderer.get();
+		frameDeadlineTime = std::chrono::steady_clock::time_point::max();
+		if (frameDeadline > 0) {
+			frameDeadlineTime = frameTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(frameDeadline));
 		}
 
-		//! Add tasks to render pool
-		renderPool.AddTasks(tasks);
-
-		renderPool.WaitIdle();
+		frameGraph.Run(renderPool);
 #endif
 
-
-		renderer->DisplayFrame();
 		return true;
 	}
 
+	//! _BuildFrameGraph
+	//! Builds the stages of a frame as a task graph on the render pool. The next frame is snapshotted and
+	//! traced while the previous one is upscaled and presented; the frame completes once both are done
+	//! 
+	//!   snapshot -> render ------------------> end
+	//!   output ---> upscale --> present -----/
+	//! 
+	//! Snapshot, output, present and end run on the calling thread, which owns the window, its textures and the input state
+	//! 
+	void Engine::_BuildFrameGraph() {
+		Renderer::Renderer* rendererRef = renderer.get();
+		frameGraph.Clear();
+
+		//! Trace batch by batch, most expensive first; idle render threads steal halves of the remaining batch range
+		renderNodeIdx = frameGraph.AddNode(0, 0, 1, [rendererRef](int startIdx, int endIdx) {
+			for (int batchI = startIdx; batchI < endIdx; batchI++) {
+				rendererRef->RenderTileBatch(batchI);
+			}
+		});
+
+		//! Submit the next frame with the camera as of now; input handled while it renders applies to the frame after
+		int snapshotNodeIdx = frameGraph.AddCallerNode([this](int, int) {
+			renderer->BeginFrame(player->GetCamera(), frameDeadlineTime);
+			frameGraph.SetRange(renderNodeIdx, 0, (int)renderer->GetTileBatches().size());
+		});
+
+		//! Upscale the previous frame in bands of rows, then present it and poll input
+		int outputNodeIdx = frameGraph.AddCallerNode([rendererRef](int, int) {
+			rendererRef->BeginOutput();
+		});
+		int upscaleNodeIdx = frameGraph.AddNode(0, renderer->GetWindowHeight(), outputRowGrain, [rendererRef](int rowBegin, int rowEnd) {
+			rendererRef->PrepareOutput(rowBegin, rowEnd);
+		});
+		int presentNodeIdx = frameGraph.AddCallerNode([rendererRef](int, int) {
+			rendererRef->PresentFrame();
+		});
+
+		int endNodeIdx = frameGraph.AddCallerNode([rendererRef](int, int) {
+			rendererRef->EndFrame();
+			if (rendererRef->GetFallbackTileCount() > 0) {
+				LOG_DEBUG("Engine: " + std::to_string(rendererRef->GetFallbackTileCount()) + " tiles missed the frame deadline");
+			}
+		});
+
+		frameGraph.AddEdge(snapshotNodeIdx, renderNodeIdx);
+		frameGraph.AddEdge(outputNodeIdx, upscaleNodeIdx);
+		frameGraph.AddEdge(upscaleNodeIdx, presentNodeIdx);
+		frameGraph.AddEdge(renderNodeIdx, endNodeIdx);
+		frameGraph.AddEdge(presentNodeIdx, endNodeIdx);
+	}
+
 }; // namespace Engine
\ No newline at end of file
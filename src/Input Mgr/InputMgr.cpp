@@ -73,7 +73,7 @@ namespace InputMgr {
 				break;
 
 			default:
-				Util::Log::Error("InputMgr: Unhandled action found in mapped action list");
+				LOG_ERROR("InputMgr: Unhandled action found in mapped action list");
 				break;
 			}
 		}		
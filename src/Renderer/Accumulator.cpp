@@ -0,0 +1,65 @@
+//!
+//! Accumulator.cpp
+//! Progressive averaging of the radiance of successive frames of an unchanged view
+//!
+#include "Accumulator.h"
+#include <algorithm>
+
+
+
+namespace Renderer {
+
+	//! Reset
+	//! Discards all samples and sizes the accumulator for frames of the given size
+	//!
+	void Accumulator::Reset(int width, int height) {
+		if (!HasSize(width, height)) {
+			mean = std::make_unique<HdrFrame>("AccumulatedFrame", width, height);
+			sampleCounts.resize((size_t)mean->GetPitch() * height);
+		}
+		std::fill(sampleCounts.begin(), sampleCounts.end(), 0);
+		nFrames = 0;
+	}
+
+	//! Clear
+	//! Discards all samples and storage; the next frame must reset the accumulator to its size
+	//!
+	void Accumulator::Clear() {
+		mean.reset();
+		sampleCounts.clear();
+		nFrames = 0;
+	}
+
+	//! BeginFrame
+	//! Counts a new frame of samples
+	//!
+	void Accumulator::BeginFrame() {
+		nFrames++;
+	}
+
+	//! AccumulateRect
+	//! Folds the samples of the given rectangle of the frame into the mean, then replaces them with the mean
+	//! The frame must have the size of the accumulator. Disjoint rectangles may be accumulated concurrently
+	//!
+	void Accumulator::AccumulateRect(HdrFrame& frame, int x, int y, int rectWidth, int rectHeight) {
+		const int pitch = mean->GetPitch();
+
+		for (int py = y; py < y + rectHeight; py++) {
+			uint32_t* counts = sampleCounts.data() + (size_t)py * pitch;
+			for (int channelI = 0; channelI < HdrFrame::CHANNEL_COUNT; channelI++) {
+				float* samples = frame.GetRow((HdrFrame::Channel)channelI, py);
+				float* means = mean->GetRow((HdrFrame::Channel)channelI, py);
+				for (int px = x; px < x + rectWidth; px++) {
+					//! The first sample replaces whatever the mean held before the reset
+					means[px] = (counts[px] == 0) ? samples[px] : means[px] + (samples[px] - means[px]) / (float)(counts[px] + 1);
+					samples[px] = means[px];
+				}
+			}
+
+			for (int px = x; px < x + rectWidth; px++) {
+				counts[px]++;
+			}
+		}
+	}
+
+}; // namespace Renderer
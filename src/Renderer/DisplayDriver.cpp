@@ -3,6 +3,7 @@
 //! Establishes an abstracted interface to the SDL3 display
 //! 
 #include "DisplayDriver.h"
+#include <algorithm>
 
 
 
@@ -20,26 +21,27 @@ namespace Renderer {
 	//! Destructor
 	//!
 	DisplayDriver::~DisplayDriver() {
-		if (texture) SDL_DestroyTexture(texture);
+		for (SDL_Texture* texture : textures) SDL_DestroyTexture(texture);
 		if (renderer) SDL_DestroyRenderer(renderer);
 		if (window) SDL_DestroyWindow(window);
-		SDL_Quit();
+		if (isSdlInitialized) SDL_Quit();
 	}
 
 	//! Init
-	//! Initializes the SDL layer
+	//! Initializes the SDL layer with the given number of window sized textures
 	//! 
-	bool DisplayDriver::Init() {
+	bool DisplayDriver::Init(int nTextures) {
 		if (IsActive()) {
-			Util::Log::Error("Attempted to initialize an already active display driver");
+			LOG_ERROR("Attempted to initialize an already active display driver");
 			return false;
 		}
 
 		//! Initialize SDL
 		if (!SDL_Init(SDL_INIT_VIDEO)) {
-			Util::Log::Error("SDL_Init Error: " + (std::string)SDL_GetError());
+			LOG_ERROR("SDL_Init Error: " + (std::string)SDL_GetError());
 			return false;
 		}
+		this->isSdlInitialized = true;
 
 		//! Initialize window
 		this->window = SDL_CreateWindow(windowTitle, windowWidth, windowHeight, NULL);
@@ -53,14 +55,17 @@ namespace Renderer {
 			return false;
 		}
 
-		//! Initialize texture for pixel buffer
-		this->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, this->windowWidth, this->windowHeight);
-		if (!texture) {
-			Util::Log::Error("SDL_CreateTexture Error: " + (std::string)SDL_GetError());
-			return false;
+		//! Initialize textures for pixel buffers
+		for (int textureI = 0; textureI < nTextures; textureI++) {
+			SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_STREAMING, this->windowWidth, this->windowHeight);
+			if (!texture) {
+				LOG_ERROR("SDL_CreateTexture Error: " + (std::string)SDL_GetError());
+				return false;
+			}
+			textures.push_back(texture);
 		}
 
-		Util::Log::Info("Display driver initialized successfully");
+		LOG_INFO("Display driver initialized successfully");
 		this->isInitialized = true;
 		return true;
 	}
@@ -84,19 +89,65 @@ namespace Renderer {
 	}
 
 	//! RenderFrame
-	//! Renders the provided frame buffer to the window
+	//! Copies the provided window sized frame buffer into the given texture and renders it to the window
 	//! 
-	void DisplayDriver::RenderFrame(const Frame& frame) {
+	void DisplayDriver::RenderFrame(const Frame& frame, int textureIdx) {
 		if (!IsActive()) return;
 
-		//! Set texture
-		SDL_LockTexture(texture, NULL, &pixels, &pitch);
-		memcpy(pixels, frame.GetBuffer(), pitch * this->windowHeight);
-		SDL_UnlockTexture(texture);
+		//! Set texture; the rows of both may be padded beyond the frame width
+		PixelView view = LockTexture(textureIdx);
+		if (view.pixels == nullptr) return;
+
+		int rowCount = std::min(view.height, frame.GetHeight());
+		int rowSize = std::min(view.width, frame.GetWidth());
+		for (int y = 0; y < rowCount; y++) {
+			memcpy(view.pixels + (size_t)y * view.pitch, frame.GetRow(y), rowSize * sizeof(uint32_t));
+		}
+		UnlockTexture(textureIdx);
+
+		RenderTexture(textureIdx);
+	}
+
+	//! LockTexture
+	//! Locks the given texture for writing and returns its pixels, or an empty view on failure
+	//! The pixels are write-only and must all be written before UnlockTexture. Only the display thread may lock and
+	//! unlock textures, but any thread may write the locked pixels
+	//! 
+	PixelView DisplayDriver::LockTexture(int textureIdx) {
+		if (!IsActive() || textureIdx >= textures.size()) return PixelView();
+
+		void* pixels;
+		int pitch;
+		if (!SDL_LockTexture(textures[textureIdx], NULL, &pixels, &pitch)) {
+			LOG_WARN("SDL_LockTexture Error: " + (std::string)SDL_GetError());
+			return PixelView();
+		}
+
+		PixelView view;
+		view.pixels = (uint32_t*)pixels;
+		view.width = windowWidth;
+		view.height = windowHeight;
+		view.pitch = pitch / (int)sizeof(uint32_t);
+		return view;
+	}
+
+	//! UnlockTexture
+	//! Uploads the pixels written to the given locked texture
+	//! 
+	void DisplayDriver::UnlockTexture(int textureIdx) {
+		if (textureIdx >= textures.size()) return;
+
+		SDL_UnlockTexture(textures[textureIdx]);
+	}
+
+	//! RenderTexture
+	//! Renders the given texture to the window
+	//! 
+	void DisplayDriver::RenderTexture(int textureIdx) {
+		if (!IsActive() || textureIdx >= textures.size()) return;
 
-		//! Render texture
 		SDL_RenderClear(renderer);
-		SDL_RenderTexture(renderer, texture, NULL, NULL);
+		SDL_RenderTexture(renderer, textures[textureIdx], NULL, NULL);
 		SDL_RenderPresent(renderer);
 	}
 
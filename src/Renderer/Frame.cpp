@@ -3,6 +3,8 @@
 //! Defines a modular frame buffer for pixel rendering
 //! 
 #include "Frame.h"
+#include <algorithm>
+#include <vector>
 
 
 namespace Renderer {
@@ -14,13 +16,8 @@ namespace Renderer {
 		this->name = name;
 		this->width = width;
 		this->height = height;
-		this->pixels = new uint32_t[(double)width * (double)height]();
-	}
-
-	//! Destructor
-	//! 
-	Frame::~Frame() {
-		delete this->pixels;
+		this->pitch = (width + rowAlignment - 1) / rowAlignment * rowAlignment;
+		this->pixels.assign((size_t)pitch * height, 0);
 	}
 
 	//! GetName
@@ -43,37 +40,141 @@ namespace Renderer {
 		return this->height;
 	}
 
+	//! GetPitch
+	//! Returns the number of pixels from the start of one row to the start of the next
+	//! 
+	int Frame::GetPitch() const {
+		return this->pitch;
+	}
+
 	//! GetBuffer
-	//! Returns the raw frame buffer data
+	//! Returns the raw frame buffer data, whose rows are GetPitch() pixels apart
 	//! 
+	uint32_t* Frame::GetBuffer() {
+		return this->pixels.data();
+	}
+
 	const uint32_t* Frame::GetBuffer() const {
-		return this->pixels;
+		return this->pixels.data();
+	}
+
+	//! GetView
+	//! Returns the frame buffer as a writable view
+	//! 
+	PixelView Frame::GetView() {
+		return GetView(0, 0, width, height);
+	}
+
+	//! GetView
+	//! Returns the given rectangle of the frame buffer as a writable view, clipped to the frame
+	//! 
+	PixelView Frame::GetView(int x, int y, int viewWidth, int viewHeight) {
+		x = std::clamp(x, 0, width);
+		y = std::clamp(y, 0, height);
+
+		PixelView view;
+		view.pixels = GetRow(y) + x;
+		view.width = std::min(viewWidth, width - x);
+		view.height = std::min(viewHeight, height - y);
+		view.pitch = this->pitch;
+		return view;
 	}
 
 	//! SetPixel
 	//! Sets a pixel at the given position to the provided color
 	void Frame::SetPixel(int x, int y, uint32_t color) {
 		if (x >= width || y >= height) {
-			Util::Log::Warn("Attempted to set pixel outside the boundaries of frame");
+			LOG_WARN("Attempted to set pixel outside the boundaries of frame");
 			return;
 		}
 
-		this->pixels[x + (width * y)] = color;
+		GetRow(y)[x] = color;
 	}
 
 	//! SetPixel
 	//! Sets a pixel at the given position to the provided color
 	void Frame::SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
-		this->SetPixel(x, y, (r << 6 | g << 4 | b << 2 | a));
+		this->SetPixel(x, y, (uint32_t)r << 24 | (uint32_t)g << 16 | (uint32_t)b << 8 | a);
 	}
 
 	uint32_t Frame::GetPixel(int x, int y) {
 		if (x >= width || y >= height) {
-			Util::Log::Warn("Attempted to get pixel outside the boundaries of frame");
+			LOG_WARN("Attempted to get pixel outside the boundaries of frame");
 			return 0;
 		}
 
-		return pixels[x + (width * y)];
+		return GetRow(y)[x];
+	}
+
+	//! ResampleFrom
+	//! Fills the frame with a bilinear resampling of the given frame, aligning pixel centers
+	//! 
+	void Frame::ResampleFrom(const Frame& source) {
+		ResampleFrom(source, 0, height);
+	}
+
+	//! ResampleFrom
+	//! Fills rows [rowBegin, rowEnd) of the frame with a bilinear resampling of the given frame, aligning pixel centers
+	//! Disjoint rows may be filled concurrently
+	//! 
+	void Frame::ResampleFrom(const Frame& source, int rowBegin, int rowEnd) {
+		Resample(source, GetView(), rowBegin, rowEnd);
+	}
+
+	//! Resample
+	//! Fills rows [rowBegin, rowEnd) of the target with a bilinear resampling of the given frame, aligning pixel centers
+	//! Channels are blended two at a time in 16-bit lanes with 8-bit weights. Disjoint rows may be filled concurrently
+	//! 
+	void Frame::Resample(const Frame& source, const PixelView& target, int rowBegin, int rowEnd) {
+		const int width = target.width;
+		const int height = target.height;
+		rowBegin = std::max(rowBegin, 0);
+		rowEnd = std::min(rowEnd, height);
+		if (rowEnd <= rowBegin) {
+			return;
+		}
+
+		if (source.width == width && source.height == height) {
+			for (int y = rowBegin; y < rowEnd; y++) {
+				std::copy(source.GetRow(y), source.GetRow(y) + width, target.pixels + (size_t)y * target.pitch);
+			}
+			return;
+		}
+
+		//! Source sample positions in 1/256 pixel units, clamped to the edge pixel centers
+		auto samplePos = [](int dstIdx, int dstSize, int srcSize) {
+			int pos = (int)(((2 * dstIdx + 1) * (int64_t)srcSize * 256) / (2 * dstSize)) - 128;
+			return std::clamp(pos, 0, (srcSize - 1) * 256);
+		};
+
+		thread_local std::vector<int> columnPos;	// Reused between calls
+		columnPos.resize(width);
+		for (int x = 0; x < width; x++) {
+			columnPos[x] = samplePos(x, width, source.width);
+		}
+
+		constexpr uint32_t laneMask = 0x00FF00FF;
+		auto lerp = [](uint32_t a, uint32_t b, uint32_t weight) {
+			uint32_t low = (((a & laneMask) * (256 - weight) + (b & laneMask) * weight) >> 8) & laneMask;
+			uint32_t high = ((((a >> 8) & laneMask) * (256 - weight) + ((b >> 8) & laneMask) * weight) >> 8) & laneMask;
+			return low | (high << 8);
+		};
+
+		for (int y = rowBegin; y < rowEnd; y++) {
+			int rowPos = samplePos(y, height, source.height);
+			const uint32_t* row0 = source.GetRow(rowPos >> 8);
+			const uint32_t* row1 = source.GetRow(std::min((rowPos >> 8) + 1, source.height - 1));
+			uint32_t rowWeight = rowPos & 0xFF;
+
+			uint32_t* dst = target.pixels + (size_t)y * target.pitch;
+			for (int x = 0; x < width; x++) {
+				int x0 = columnPos[x] >> 8;
+				int x1 = std::min(x0 + 1, source.width - 1);
+				uint32_t columnWeight = columnPos[x] & 0xFF;
+
+				dst[x] = lerp(lerp(row0[x0], row0[x1], columnWeight), lerp(row1[x0], row1[x1], columnWeight), rowWeight);
+			}
+		}
 	}
 
 }; // namespace Renderer
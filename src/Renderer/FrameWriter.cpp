@@ -0,0 +1,247 @@
+//!
+//! FrameWriter.cpp
+//! Writes rendered frames to image files
+//!
+#include "FrameWriter.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+
+
+namespace Renderer {
+
+	namespace FrameWriter {
+
+		/* ----------------------------------------------------------------
+		 * Shared helpers
+		 * ---------------------------------------------------------------- */
+
+		//! Frame pixels are packed RGBA with red in the most significant byte
+		static void _UnpackRGB(uint32_t pixel, uint8_t* rgb) {
+			rgb[0] = (uint8_t)(pixel >> 24);
+			rgb[1] = (uint8_t)(pixel >> 16);
+			rgb[2] = (uint8_t)(pixel >> 8);
+		}
+
+		static std::string _GetExtension(const std::string& path) {
+			std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+			return extension;
+		}
+
+		static bool _WriteFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+			std::ofstream file(path, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				LOG_ERROR("FrameWriter: Failed to open " + path + " for writing");
+				return false;
+			}
+
+			file.write((const char*)bytes.data(), bytes.size());
+			if (!file) {
+				LOG_ERROR("FrameWriter: Failed to write " + path);
+				return false;
+			}
+			return true;
+		}
+
+		static void _AppendBigEndian32(std::vector<uint8_t>& bytes, uint32_t value) {
+			bytes.push_back((uint8_t)(value >> 24));
+			bytes.push_back((uint8_t)(value >> 16));
+			bytes.push_back((uint8_t)(value >> 8));
+			bytes.push_back((uint8_t)value);
+		}
+
+		/* ----------------------------------------------------------------
+		 * PPM
+		 * ---------------------------------------------------------------- */
+
+		//! _WritePPM
+		//! Binary (P6) 8-bit RGB
+		//!
+		static bool _WritePPM(const Frame& frame, const std::string& path) {
+			std::string header = "P6\n" + std::to_string(frame.GetWidth()) + " " + std::to_string(frame.GetHeight()) + "\n255\n";
+
+			std::vector<uint8_t> bytes(header.begin(), header.end());
+			bytes.resize(header.size() + 3 * (size_t)frame.GetWidth() * frame.GetHeight());
+
+			uint8_t* dst = bytes.data() + header.size();
+			for (int y = 0; y < frame.GetHeight(); y++) {
+				const uint32_t* row = frame.GetRow(y);
+				for (int x = 0; x < frame.GetWidth(); x++, dst += 3) {
+					_UnpackRGB(row[x], dst);
+				}
+			}
+
+			return _WriteFile(path, bytes);
+		}
+
+		/* ----------------------------------------------------------------
+		 * PNG
+		 * ---------------------------------------------------------------- */
+
+		static uint32_t _Crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+			static const std::array<uint32_t, 256> table = []() {
+				std::array<uint32_t, 256> entries;
+				for (uint32_t entryI = 0; entryI < 256; entryI++) {
+					uint32_t value = entryI;
+					for (int bitI = 0; bitI < 8; bitI++) {
+						value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+					}
+					entries[entryI] = value;
+				}
+				return entries;
+			}();
+
+			crc = ~crc;
+			for (size_t byteI = 0; byteI < size; byteI++) {
+				crc = table[(crc ^ data[byteI]) & 0xFF] ^ (crc >> 8);
+			}
+			return ~crc;
+		}
+
+		static void _AppendChunk(std::vector<uint8_t>& bytes, const char* type, const std::vector<uint8_t>& data) {
+			_AppendBigEndian32(bytes, (uint32_t)data.size());
+			size_t typeStart = bytes.size();
+			bytes.insert(bytes.end(), type, type + 4);
+			bytes.insert(bytes.end(), data.begin(), data.end());
+			_AppendBigEndian32(bytes, _Crc32(bytes.data() + typeStart, bytes.size() - typeStart));
+		}
+
+		//! _WritePNG
+		//! 8-bit RGB. Scanlines are stored uncompressed in deflate stored blocks, which keeps the writer free
+		//! of a compression library; output is larger than a compressing encoder's but decodes anywhere
+		//!
+		static bool _WritePNG(const Frame& frame, const std::string& path) {
+			const int width = frame.GetWidth();
+			const int height = frame.GetHeight();
+
+			//! Scanlines with filter type 0 (none)
+			std::vector<uint8_t> scanlines((size_t)height * (1 + 3 * width));
+			uint8_t* dst = scanlines.data();
+			for (int y = 0; y < height; y++) {
+				const uint32_t* row = frame.GetRow(y);
+				*dst++ = 0;
+				for (int x = 0; x < width; x++, dst += 3) {
+					_UnpackRGB(row[x], dst);
+				}
+			}
+
+			//! zlib stream of stored blocks of at most 65535 bytes, followed by the Adler-32 of the data
+			constexpr size_t maxBlockSize = 65535;
+			std::vector<uint8_t> zlib = { 0x78, 0x01 };
+			zlib.reserve(scanlines.size() + 5 * (scanlines.size() / maxBlockSize + 1) + 6);
+			size_t blockStart = 0;
+			do {
+				size_t blockSize = std::min(maxBlockSize, scanlines.size() - blockStart);
+				bool isFinal = blockStart + blockSize == scanlines.size();
+				zlib.push_back(isFinal ? 1 : 0);
+				zlib.push_back((uint8_t)blockSize);
+				zlib.push_back((uint8_t)(blockSize >> 8));
+				zlib.push_back((uint8_t)~blockSize);
+				zlib.push_back((uint8_t)(~blockSize >> 8));
+				zlib.insert(zlib.end(), scanlines.begin() + blockStart, scanlines.begin() + blockStart + blockSize);
+				blockStart += blockSize;
+			} while (blockStart < scanlines.size());
+
+			uint32_t adlerA = 1, adlerB = 0;
+			for (uint8_t byte : scanlines) {
+				adlerA = (adlerA + byte) % 65521;
+				adlerB = (adlerB + adlerA) % 65521;
+			}
+			_AppendBigEndian32(zlib, (adlerB << 16) | adlerA);
+
+			//! Header: size, 8-bit depth, truecolor, default compression/filter, no interlace
+			std::vector<uint8_t> header;
+			_AppendBigEndian32(header, (uint32_t)width);
+			_AppendBigEndian32(header, (uint32_t)height);
+			header.insert(header.end(), { 8, 2, 0, 0, 0 });
+
+			std::vector<uint8_t> bytes = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+			_AppendChunk(bytes, "IHDR", header);
+			_AppendChunk(bytes, "IDAT", zlib);
+			_AppendChunk(bytes, "IEND", {});
+			return _WriteFile(path, bytes);
+		}
+
+		/* ----------------------------------------------------------------
+		 * Interface
+		 * ---------------------------------------------------------------- */
+
+		//! Write
+		//! Writes the frame to the given path, selecting the format by file extension (.ppm, .png or .pfm)
+		//!
+		bool Write(const Frame& frame, const std::string& path, const HdrFrame* hdrFrame) {
+			std::string extension = _GetExtension(path);
+
+			if (extension == ".ppm") {
+				return _WritePPM(frame, path);
+			}
+			if (extension == ".png") {
+				return _WritePNG(frame, path);
+			}
+			if (extension == ".pfm") {
+				const int width = frame.GetWidth();
+				const int height = frame.GetHeight();
+				std::vector<float> rgb(3 * (size_t)width * height);
+				if (hdrFrame != nullptr && hdrFrame->GetWidth() == width && hdrFrame->GetHeight() == height) {
+					for (int channelI = 0; channelI < HdrFrame::CHANNEL_COUNT; channelI++) {
+						for (int y = 0; y < height; y++) {
+							const float* row = hdrFrame->GetRow((HdrFrame::Channel)channelI, y);
+							for (int x = 0; x < width; x++) {
+								rgb[3 * ((size_t)y * width + x) + channelI] = row[x];
+							}
+						}
+					}
+				}
+				else {
+					for (int y = 0; y < height; y++) {
+						const uint32_t* row = frame.GetRow(y);
+						for (int x = 0; x < width; x++) {
+							uint8_t channels[3];
+							_UnpackRGB(row[x], channels);
+							for (int channelI = 0; channelI < 3; channelI++) {
+								rgb[3 * ((size_t)y * width + x) + channelI] = channels[channelI] / 255.0f;
+							}
+						}
+					}
+				}
+				return WriteFloat(rgb.data(), width, height, path);
+			}
+
+			LOG_ERROR("FrameWriter: Unsupported image format '" + extension + "' of " + path);
+			return false;
+		}
+
+		//! WriteFloat
+		//! Writes linear RGB float pixels, rows top to bottom, to the given path as PFM
+		//! PFM stores rows bottom to top; a negative scale marks little-endian samples
+		//!
+		bool WriteFloat(const float* rgb, int width, int height, const std::string& path) {
+			if (_GetExtension(path) != ".pfm") {
+				LOG_ERROR("FrameWriter: Float images can only be written as .pfm, not " + path);
+				return false;
+			}
+
+			std::string header = "PF\n" + std::to_string(width) + " " + std::to_string(height) + "\n-1.0\n";
+
+			std::vector<uint8_t> bytes(header.begin(), header.end());
+			size_t rowSize = 3 * sizeof(float) * (size_t)width;
+			bytes.resize(header.size() + rowSize * height);
+
+			//! Samples are written in host order, which is little-endian on every supported platform
+			for (int y = 0; y < height; y++) {
+				std::memcpy(bytes.data() + header.size() + (size_t)(height - 1 - y) * rowSize, rgb + 3 * (size_t)y * width, rowSize);
+			}
+
+			return _WriteFile(path, bytes);
+		}
+
+	}; // namespace FrameWriter
+
+}; // namespace Renderer
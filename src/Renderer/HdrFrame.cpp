@@ -0,0 +1,128 @@
+//!
+//! HdrFrame.cpp
+//! Defines a linear float frame buffer for accumulating radiance
+//!
+#include "HdrFrame.h"
+#include <algorithm>
+
+
+
+namespace Renderer {
+
+	//! Constructor
+	//! Creates a black frame of the specified size
+	//!
+	HdrFrame::HdrFrame(std::string name, int width, int height)
+		: name(name)
+		, width(width)
+		, height(height)
+		, pitch((width + rowAlignment - 1) / rowAlignment * rowAlignment)
+		, planes((size_t)CHANNEL_COUNT * pitch * height, 0.0f)
+	{}
+
+	//! GetName
+	//! Returns the name of the frame
+	//!
+	std::string HdrFrame::GetName() const {
+		return name;
+	}
+
+	//! GetWidth
+	//! Returns the number of pixels horizontally
+	//!
+	int HdrFrame::GetWidth() const {
+		return width;
+	}
+
+	//! GetHeight
+	//!
+	int HdrFrame::GetHeight() const {
+		return height;
+	}
+
+	//! GetPitch
+	//! Returns the number of samples from the start of one row to the start of the next
+	//!
+	int HdrFrame::GetPitch() const {
+		return pitch;
+	}
+
+	//! GetPlane
+	//! Returns the row-major samples of the given channel, whose rows are GetPitch() samples apart
+	//!
+	float* HdrFrame::GetPlane(Channel channel) {
+		return GetRow(channel, 0);
+	}
+
+	const float* HdrFrame::GetPlane(Channel channel) const {
+		return GetRow(channel, 0);
+	}
+
+	//! SetPixel
+	//! Sets the radiance of the pixel at the given position
+	//!
+	void HdrFrame::SetPixel(int x, int y, float r, float g, float b) {
+		if (x >= width || y >= height) {
+			LOG_WARN("Attempted to set pixel outside the boundaries of HDR frame");
+			return;
+		}
+
+		size_t pixelIdx = x + (size_t)pitch * y;
+		GetPlane(RED)[pixelIdx] = r;
+		GetPlane(GREEN)[pixelIdx] = g;
+		GetPlane(BLUE)[pixelIdx] = b;
+	}
+
+	//! AddPixel
+	//! Adds to the radiance of the pixel at the given position
+	//!
+	void HdrFrame::AddPixel(int x, int y, float r, float g, float b) {
+		if (x >= width || y >= height) {
+			LOG_WARN("Attempted to add to pixel outside the boundaries of HDR frame");
+			return;
+		}
+
+		size_t pixelIdx = x + (size_t)pitch * y;
+		GetPlane(RED)[pixelIdx] += r;
+		GetPlane(GREEN)[pixelIdx] += g;
+		GetPlane(BLUE)[pixelIdx] += b;
+	}
+
+	//! Clear
+	//! Sets every pixel to black
+	//!
+	void HdrFrame::Clear() {
+		std::fill(planes.begin(), planes.end(), 0.0f);
+	}
+
+	//! CopyRect
+	//! Copies the given rectangle from a frame of the same size
+	//!
+	void HdrFrame::CopyRect(const HdrFrame& source, int x, int y, int rectWidth, int rectHeight) {
+		if (source.width != width || source.height != height) {
+			LOG_WARN("Attempted to copy between HDR frames of different sizes");
+			return;
+		}
+
+		for (int channelI = 0; channelI < CHANNEL_COUNT; channelI++) {
+			for (int py = y; py < y + rectHeight; py++) {
+				const float* src = source.GetRow((Channel)channelI, py) + x;
+				std::copy(src, src + rectWidth, GetRow((Channel)channelI, py) + x);
+			}
+		}
+	}
+
+	//! FillRect
+	//! Sets every pixel of the given rectangle to the given radiance
+	//!
+	void HdrFrame::FillRect(int x, int y, int rectWidth, int rectHeight, float r, float g, float b) {
+		const float values[CHANNEL_COUNT] = { r, g, b };
+		for (int channelI = 0; channelI < CHANNEL_COUNT; channelI++) {
+			for (int py = y; py < y + rectHeight; py++) {
+				float* dst = GetRow((Channel)channelI, py) + x;
+				std::fill(dst, dst + rectWidth, values[channelI]);
+			}
+		}
+	}
+
+}; // namespace Renderer
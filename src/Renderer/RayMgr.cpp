@@ -10,214 +10,255 @@ namespace Renderer {
 
 	namespace RayMgr {
 
+		//! _GetCollision
+		//! Builds the collision record for a ray known to hit the given face of an object at the given distance
+		//! 
+		template <typename T>
+		static CollisionInfo<T> _GetCollision(World::World& world, const Ray<T>& ray, int objectIdx, int faceIdx, T distance) {
+			CollisionInfo<T> collision;
+			collision.object = world.GetObject(objectIdx);
+			collision.faceIdx = faceIdx;
+			const World::Primitive& primitive = collision.object->GetPrimitive();
+
+			//! Populate entry collision
+			collision.distance = distance;
+			collision.position = ray.origin + ray.direction * collision.distance;
+			collision.normal = World::GetSurfaceNormal(primitive, collision.position, ray.direction, faceIdx);
+
+			return collision;
+		}
+
 		//! GetFirstCollision
 		//! Returns the nearest object collision, if any, from the given ray
-		//! Ignores the given object if specified
+		//! Objects are culled through the world BVH, which must be up to date
 		//! 
-		std::unique_ptr<CollisionInfo> GetFirstCollision(World::World& world, const Ray& ray) {
+		template <typename T>
+		std::optional<CollisionInfo<T>> GetFirstCollision(World::World& world, const Ray<T>& ray) {
+			const Util::Vector3<Util::Real> origin(ray.origin);
+			const Util::Vector3<Util::Real> direction(ray.direction);
+
 			// Maintain the shortest distance collision
-			std::unique_ptr<CollisionInfo> collision = nullptr;
-			double minDist = INFINITY;
+			int nearestObject = -1;
+			int nearestFace = -1;
+			Util::Real minDist = INFINITY;
+
+			//! Test each batch along the ray, one primitive type at a time
+			world.ForEachBucket([&](const auto& bucket) {
+				bucket.Traverse(origin, direction, minDist, [&](int first, int count) {
+					int primIdx = bucket.GetStore().IntersectNearest(origin, direction, first, count, minDist, nearestFace);	// Also culls farther BVH nodes
+					if (primIdx != -1) {
+						nearestObject = bucket.GetStore().GetObjectIndex(primIdx);
+					}
+					return false;
+				});
+			});
+
+			if (nearestObject == -1) {
+				return std::nullopt;	// No collision found
+			}
 
-			//! Perform collision logic for all objects by default
-			int nObjects = world.GetObjectCount();
-			for (int objI = 0; objI < nObjects; objI++) {
-				World::Object* object = world.GetObject(objI);
+			return _GetCollision(world, ray, nearestObject, nearestFace, (T)minDist);
+		}
 
-				if (object == nullptr) {
-					continue;
+		//! GetFirstCollisions
+		//! Resolves the nearest collision of each ray in a coherent bundle of rays
+		//! The rays share one BVH traversal per primitive type and are tested against each batch together
+		//! Bundles larger than a packet are traced one packet at a time
+		//! 
+		template <typename T>
+		void GetFirstCollisions(World::World& world, const Ray<T>* rays, int count, std::optional<CollisionInfo<T>>* collisions) {
+			if (count > Util::RayPacket::maxSize) {
+				for (int firstRay = 0; firstRay < count; firstRay += Util::RayPacket::maxSize) {
+					GetFirstCollisions(world, rays + firstRay, std::min(count - firstRay, Util::RayPacket::maxSize), collisions + firstRay);
 				}
+				return;
+			}
 
-				//! Handle collision depending on object type
-				switch (object->GetShapeType()) {
-				case World::ShapeType::CUBE:
-				case World::ShapeType::RECTANGLE:
-				default:
-					Util::Log::Error("GetFirstCollision: Unimplemented object shape defined for collision check");
-					return nullptr;
+			//! Pack rays
+			Util::RayPacket packet;
+			int nearestObject[Util::RayPacket::maxSize];
+			int nearestFace[Util::RayPacket::maxSize];
+			packet.count = count;
+			for (int rayI = 0; rayI < packet.count; rayI++) {
+				packet.Set(rayI, Util::Vector3<Util::Real>(rays[rayI].origin), Util::Vector3<Util::Real>(rays[rayI].direction));
+				nearestObject[rayI] = -1;
+			}
+			packet.Pad(World::Lanes::width);
 
-				case World::ShapeType::SPHERE:
-					
-					Util::Vector3<double> sphereCenter = object->GetPosition();
-					double sphereRadius = 1;	// FIXME: Need children types of shape object
-					// TODO: Add rotation, scale of objects (sphere rotation does not matter)
-
-					Util::Vector3<double> offsetRayOrigin = ray.origin - sphereCenter;	// Offset ray as if sphere was at (0,0,0)
-
-					// sqrLength(rayOrigin + rayDir * distance) = r^2
-					// 
-					double a = ray.direction.Dot(ray.direction);	// Should be 1
-					double b = 2 * offsetRayOrigin.Dot(ray.direction);
-					double c = offsetRayOrigin.Dot(offsetRayOrigin) - sphereRadius * sphereRadius;
-
-					double discriminant = (b * b) - (4 * a * c);
-
-					//! Check for collision
-					//! discriminant < 0 -> miss
-					if (discriminant >= 0) {
-						double roots[] = { 
-							(-b - std::sqrt(discriminant)) / (2 * a), 
-							(-b + std::sqrt(discriminant)) / (2 * a)
-						};
-
-						//! Get index of smallest positive root
-						int minPosRootIdx = (roots[0] > 0) ? 0 : (roots[1] > 0 ? 1 : -1);
-						if (minPosRootIdx == -1) {
-							continue;	// No collision
-						}
-
-						double distance = roots[minPosRootIdx];
-
-						if (distance >= 1e-9 && distance < minDist) {	// Ignore collisions behind ray origin
-							minDist = distance;
-							if (collision == nullptr) {
-								collision = std::make_unique<CollisionInfo>();
-							}
-
-							collision->object = object;
-
-							//! Populate entry collision
-							collision->distance = distance;
-							collision->position = ray.origin + ray.direction * distance;
-							collision->normal = (collision->position - sphereCenter).Normalized();
-
-							//! Populate exit collision (identical to entry if minPosRootIdx is 1)
-							collision->exitDistance = roots[1];
-							collision->exitPosition = ray.origin + ray.direction * collision->exitDistance;
-							collision->exitNormal = (collision->exitPosition - sphereCenter).Normalized();
-						}
+			//! Trace; packet.tMax carries over between buckets, so later buckets only report closer collisions
+			world.ForEachBucket([&](const auto& bucket) {
+				int nearestPrim[Util::RayPacket::maxSize];
+				std::fill(nearestPrim, nearestPrim + packet.count, -1);
+
+				bucket.TraversePacket(packet, [&](int first, int count) {
+					bucket.GetStore().IntersectPacketNearest(packet, first, count, nearestPrim, nearestFace);
+					return false;
+				});
+
+				for (int rayI = 0; rayI < packet.count; rayI++) {
+					if (nearestPrim[rayI] != -1) {
+						nearestObject[rayI] = bucket.GetStore().GetObjectIndex(nearestPrim[rayI]);
 					}
+				}
+			});
 
-					break;
+			//! Populate collisions
+			for (int rayI = 0; rayI < packet.count; rayI++) {
+				if (nearestObject[rayI] == -1) {
+					collisions[rayI] = std::nullopt;
+				}
+				else {
+					collisions[rayI] = _GetCollision(world, rays[rayI], nearestObject[rayI], nearestFace[rayI], (T)packet.tMax[rayI]);
 				}
 			}
-
-			//! No collision found
-			return collision;
 		}
 
-		std::unique_ptr<CollisionInfo> GetInternalCollision(World::Object& object, const Ray& ray) {
-			// TODO: Both collision functions can share an internal collision function
+		//! GetInternalCollision
+		//! Returns the collision of the given ray with a single object, if any
+		//! Objects without volume have no interior for the ray to travel through
+		//! 
+		template <typename T>
+		std::optional<CollisionInfo<T>> GetInternalCollision(World::Object& object, const Ray<T>& ray) {
+			const World::Primitive& primitive = object.GetPrimitive();
+			if (!World::HasVolume(primitive)) {
+				return std::nullopt;
+			}
 
-			// Maintain the shortest distance collision
-			std::unique_ptr<CollisionInfo> collision = nullptr;
-
-			//! Handle collision depending on object type
-			switch (object.GetShapeType()) {
-			case World::ShapeType::CUBE:
-			case World::ShapeType::RECTANGLE:
-			default:
-				Util::Log::Error("GetFirstCollision: Unimplemented object shape defined for collision check");
-				return nullptr;
-
-			case World::ShapeType::SPHERE:
-
-				Util::Vector3<double> sphereCenter = object.GetPosition();
-				double sphereRadius = 1;	// FIXME: Need children types of shape object
-				// TODO: Add rotation, scale of objects (sphere rotation does not matter)
-
-				Util::Vector3<double> offsetRayOrigin = ray.origin - sphereCenter;	// Offset ray as if sphere was at (0,0,0)
-
-				// sqrLength(rayOrigin + rayDir * distance) = r^2
-				// 
-				double a = ray.direction.Dot(ray.direction);	// Should be 1
-				double b = 2 * offsetRayOrigin.Dot(ray.direction);
-				double c = offsetRayOrigin.Dot(offsetRayOrigin) - sphereRadius * sphereRadius;
-
-				double discriminant = (b * b) - (4 * a * c);
-
-				//! Check for collision
-				//! discriminant < 0 -> miss
-				if (discriminant >= 0) {
-					double roots[] = {
-						(-b - std::sqrt(discriminant)) / (2 * a),
-						(-b + std::sqrt(discriminant)) / (2 * a)
-					};
-
-					//! Get index of smallest positive root
-					int minPosRootIdx = (roots[0] > 0) ? 0 : (roots[1] > 0 ? 1 : -1);
-					if (minPosRootIdx == -1) {
-						return nullptr;	// No collision
-					}
+			//! Check for collision
+			T roots[2];
+			if (!World::IntersectPrimitive(primitive, ray.origin, ray.direction, roots[0], roots[1])) {
+				return std::nullopt;
+			}
+
+			//! Get index of smallest positive root
+			int minPosRootIdx = (roots[0] > 0) ? 0 : (roots[1] > 0 ? 1 : -1);
+			if (minPosRootIdx == -1) {
+				return std::nullopt;	// No collision
+			}
 
-					double distance = roots[minPosRootIdx];
+			T distance = roots[minPosRootIdx];
 
-					if (distance >= 0) {	// Ignore collisions behind ray origin
-						if (collision == nullptr) {
-							collision = std::make_unique<CollisionInfo>();
-						}
+			if (distance < 0) {	// Ignore collisions behind ray origin
+				return std::nullopt;
+			}
 
-						collision->object = &object;
+			CollisionInfo<T> collision;
+			collision.object = &object;
 
-						//! Populate entry collision
-						collision->distance = distance;
-						collision->position = ray.origin + ray.direction * distance;
-						collision->normal = (collision->position - sphereCenter).Normalized();
+			//! Populate entry collision
+			collision.distance = distance;
+			collision.position = ray.origin + ray.direction * distance;
+			collision.normal = World::GetSurfaceNormal(primitive, collision.position, ray.direction, collision.faceIdx);
 
-						// TODO: Clarity, these should always be identical in this function
-						//! Populate exit collision (identical to entry if minPosRootIdx is 1)
-						collision->exitDistance = roots[1];
-						collision->exitPosition = ray.origin + ray.direction * collision->exitDistance;
-						collision->exitNormal = (collision->exitPosition - sphereCenter).Normalized();
-					}
-				}
+			return collision;
+		}
 
+		//! GetExitCollision
+		//! Resolves the exit position and normal of a collision along the ray that produced it
+		//! Only refraction needs the exit, so the primitive is intersected again here rather than for every hit
+		//! 
+		template <typename T>
+		ExitCollision<T> GetExitCollision(const Ray<T>& ray, const CollisionInfo<T>& colInfo) {
+			const World::Primitive& primitive = colInfo.object->GetPrimitive();
+			ExitCollision<T> exitCol;
+
+			//! Surfaces without volume are left where they are entered
+			if (!World::HasVolume(primitive)) {
+				exitCol.position = colInfo.position;
+				exitCol.normal = colInfo.normal.Reversed();
+				return exitCol;
 			}
 
-			return collision;
+			//! Exit distance (identical to entry if the ray starts inside the object)
+			T tNear, tFar;
+			T exitDistance = World::IntersectPrimitive(primitive, ray.origin, ray.direction, tNear, tFar) ? tFar : colInfo.distance;
+
+			exitCol.position = ray.origin + ray.direction * exitDistance;
+			exitCol.normal = World::GetSurfaceNormal(primitive, exitCol.position, ray.direction.Reversed(), colInfo.faceIdx);	// Outward along the ray
+			return exitCol;
+		}
+
+		//! IsOccluded
+		//! Returns whether any object blocks the given ray before tMax
+		//! Terminates on the first blocking object found, without resolving the nearest one
+		//! 
+		template <typename T>
+		bool IsOccluded(World::World& world, const Ray<T>& ray, T tMax) {
+			const Util::Vector3<Util::Real> origin(ray.origin);
+			const Util::Vector3<Util::Real> direction(ray.direction);
+			Util::Real maxDist = (Util::Real)tMax;
+			bool isOccluded = false;
+
+			world.ForEachBucket([&](const auto& bucket) {
+				if (isOccluded) {
+					return;
+				}
+
+				bucket.Traverse(origin, direction, maxDist, [&](int first, int count) {
+					isOccluded = bucket.GetStore().IntersectAny(origin, direction, first, count, maxDist);
+					return isOccluded;
+				});
+			});
+
+			return isOccluded;
 		}
 
 		//! GetDiffuseRays
-		//! Returns the list of rays used to calculate diffuse light
+		//! Appends the rays used to calculate diffuse light at the collision to the given list
 		//! 
-		std::vector<RayMgr::Ray> RayMgr::GetDiffuseRays(const RayMgr::CollisionInfo* colInfo) {
+		template <typename T>
+		void GetDiffuseRays(const CollisionInfo<T>* colInfo, std::vector<DiffuseRay<T>>& rays) {
 			if (colInfo == nullptr) {
-				Util::Log::Error("GetDiffuseRays: Cannot create diffuse rays from null collision");
-				return std::vector<RayMgr::Ray>();
+				LOG_ERROR("GetDiffuseRays: Cannot create diffuse rays from null collision");
+				return;
 			}
 
 			// FIXME: Make this work in a loop of all lights
-			const Util::Vector3<double> lightPos = { 0,5,3 };
-			RayMgr::Ray diffuseRay;
-			diffuseRay.origin = colInfo->position;
-			diffuseRay.direction = (lightPos - diffuseRay.origin).Normalized();
+			const Util::Vector3<T> lightPos = { 0,5,3 };
+			Util::Vector3<T> toLight = lightPos - colInfo->position;
+
+			DiffuseRay<T> diffuseRay;
+			diffuseRay.lightDistance = toLight.Magnitude();
+			diffuseRay.ray.origin = colInfo->position;
+			diffuseRay.ray.direction = toLight.Normalized();
 
 			//! Construct rays
-			std::vector<RayMgr::Ray> rays{ diffuseRay };
-			return rays;
+			rays.push_back(diffuseRay);
 		}
 
-		RayMgr::Ray RayMgr::GetReflectionRay(const RayMgr::Ray& ray, const RayMgr::CollisionInfo* colInfo) {
+		template <typename T>
+		Ray<T> GetReflectionRay(const Ray<T>& ray, const CollisionInfo<T>* colInfo) {
 			if (colInfo == nullptr) {
-				Util::Log::Error("GetReflectionRay: Cannot create reflection ray from null collision");
-				return RayMgr::Ray();
+				LOG_ERROR("GetReflectionRay: Cannot create reflection ray from null collision");
+				return Ray<T>();
 			}
 
 			//! Construct ray
-			RayMgr::Ray reflRay;
+			Ray<T> reflRay;
 			reflRay.origin = colInfo->position;
 			reflRay.direction = ray.direction - 2 * (ray.direction.Dot(colInfo->normal)) * colInfo->normal;
 			return reflRay;
 		}
 
-		RayMgr::Ray RayMgr::GetRefractionRay(const RayMgr::Ray& ray, const RayMgr::CollisionInfo* colInfo) {
+		template <typename T>
+		Ray<T> GetRefractionRay(const Ray<T>& ray, const CollisionInfo<T>* colInfo) {
 			if (colInfo == nullptr) {
-				Util::Log::Error("GetRefractionRay: Cannot create refraction ray from null collision");
-				return RayMgr::Ray();
+				LOG_ERROR("GetRefractionRay: Cannot create refraction ray from null collision");
+				return Ray<T>();
 			}
 
 			// TODO: Functionize
 			/* ----------------------------------------------------------------
 			* Apply refraction via Snell's law
 			* ---------------------------------------------------------------- */
-			const double n1 = 1;		// TODO: Add to material mgr?
-			const double n2 = 1.1;		// TODO: Add to material
+			const T n1 = 1;			// TODO: Add to material mgr?
+			const T n2 = T(1.1);	// TODO: Add to material
 
 			//! Determine refracted entry vector
 			//! 
-			double eta = n1 / n2;	// Refractive index ratio
-			double cosI = ray.direction.Reversed().Dot(colInfo->normal);
-			double sinT2 = eta * eta * (1.0 - cosI * cosI);	// Sin^2(theta_t)
+			T eta = n1 / n2;	// Refractive index ratio
+			T cosI = ray.direction.Reversed().Dot(colInfo->normal);
+			T sinT2 = eta * eta * (1 - cosI * cosI);	// Sin^2(theta_t)
 
 			//! Assumption: Entry always occurs from air -> TIR can never occur
 			// TODO: Remove me
@@ -227,15 +268,16 @@ namespace Renderer {
 			//	return RayMgr::Ray(); // TODO: Handle internal reflection
 			//}
 
-			double cosT = std::sqrt(1 - sinT2);	// Cosine of transmitted angle
+			T cosT = std::sqrt(1 - sinT2);	// Cosine of transmitted angle
 
-			Util::Vector3<double> entryDir = (eta * ray.direction + (eta * cosI - cosT) * colInfo->normal).Normalized();
+			Util::Vector3<T> entryDir = (eta * ray.direction + (eta * cosI - cosT) * colInfo->normal).Normalized();
 
 
 			//! Determine refracted exit vector
 			//! 
+			ExitCollision<T> exitCol = GetExitCollision(ray, *colInfo);
 			eta = n2 / n1;	// Inverse
-			cosI = entryDir.Dot(colInfo->exitNormal);
+			cosI = entryDir.Dot(exitCol.normal);
 			sinT2 = eta * eta * (1.0 - cosI * cosI);	// Sin^2(theta_t)
 
 			//if (sinT2 > 1) {
@@ -250,45 +292,44 @@ namespace Renderer {
 			//! Determine if total internal reflection has occurred
 			if (sinT2 > 1) {
 				//! Create internal ray
-				RayMgr::Ray internalRay;
+				Ray<T> internalRay;
 				internalRay.direction = entryDir;
 				internalRay.origin = colInfo->position;
 
 				while (sinT2 > 1) {
 					// Handle total internal reflection
-					RayMgr::Ray reflRay = GetReflectionRay(internalRay, colInfo);
-					std::unique_ptr<CollisionInfo> internalCol = GetInternalCollision(*(colInfo->object), internalRay);
+					std::optional<CollisionInfo<T>> internalCol = GetInternalCollision(*(colInfo->object), internalRay);
 					
-					if (internalCol == nullptr) {
-						Util::Log::Error("GetRefractionRay: Internal collision not found");
-						return RayMgr::Ray();	// FIXME: Need better return handling
+					if (!internalCol) {
+						LOG_ERROR("GetRefractionRay: Internal collision not found");
+						return Ray<T>();	// FIXME: Need better return handling
 					}
 
 					// Check for exit
-					cosI = entryDir.Dot(internalCol->exitNormal);
+					ExitCollision<T> internalExit = GetExitCollision(internalRay, *internalCol);
+					cosI = internalRay.direction.Dot(internalExit.normal);
 					sinT2 = eta * eta * (1.0 - cosI * cosI);	// Sin^2(theta_t)
 
 					// Construct ray - TODO: Clarity, this works but is not an entry
 					if (sinT2 <= 1) {
 						cosT = std::sqrt(1 - sinT2);	// Cosine of transmitted angle
-						Util::Vector3<double> exitDir = (eta * internalRay.direction + (eta * cosI - cosT) * internalCol->exitNormal).Normalized();
+						Util::Vector3<T> exitDir = (eta * internalRay.direction + (eta * cosI - cosT) * internalExit.normal).Normalized();
 
-						RayMgr::Ray refrRay;
-						refrRay.origin = internalCol->exitPosition;
+						Ray<T> refrRay;
+						refrRay.origin = internalExit.position;
 						refrRay.direction = exitDir;
 
 						return refrRay;
 					}
 
-
-
-
-
+					// Reflect off the exit face and continue inside the object
+					internalRay.origin = internalExit.position;
+					internalRay.direction = internalRay.direction - 2 * cosI * internalExit.normal;
 
 					rayDepth++;
 					if (rayDepth == maxTIRRayDepth) {
-						Util::Log::Warn("GetRefractionRay: Reached max TIR depth");
-						return RayMgr::Ray();	// FIXME: Need to flag as complete and add to total ray depth
+						LOG_WARN("GetRefractionRay: Reached max TIR depth");
+						return Ray<T>();	// FIXME: Need to flag as complete and add to total ray depth
 					}
 				}
 			}
@@ -296,7 +337,7 @@ namespace Renderer {
 
 			cosT = std::sqrt(1 - sinT2);	// Cosine of transmitted angle
 
-			Util::Vector3<double> exitDir = (eta * entryDir + (eta * cosI - cosT) * colInfo->exitNormal).Normalized();
+			Util::Vector3<T> exitDir = (eta * entryDir + (eta * cosI - cosT) * exitCol.normal).Normalized();
 
 
 			// TODO: Calculate total transmission using Beer-Lambert law (per RGB component)
@@ -304,12 +345,29 @@ namespace Renderer {
 			/* ----------------------------------------------------------------
 			* Construct ray
 			* ---------------------------------------------------------------- */
-			RayMgr::Ray refrRay;
-			refrRay.origin = colInfo->exitPosition;
+			Ray<T> refrRay;
+			refrRay.origin = exitCol.position;
 			refrRay.direction = exitDir;
 			return refrRay;
 		}
 
+		/* ----------------------------------------------------------------
+		 * Explicit instantiations
+		 * ---------------------------------------------------------------- */
+#define RAYMGR_INSTANTIATE(T) \
+		template std::optional<CollisionInfo<T>> GetFirstCollision<T>(World::World&, const Ray<T>&); \
+		template void GetFirstCollisions<T>(World::World&, const Ray<T>*, int, std::optional<CollisionInfo<T>>*); \
+		template std::optional<CollisionInfo<T>> GetInternalCollision<T>(World::Object&, const Ray<T>&); \
+		template ExitCollision<T> GetExitCollision<T>(const Ray<T>&, const CollisionInfo<T>&); \
+		template bool IsOccluded<T>(World::World&, const Ray<T>&, T); \
+		template void GetDiffuseRays<T>(const CollisionInfo<T>*, std::vector<DiffuseRay<T>>&); \
+		template Ray<T> GetReflectionRay<T>(const Ray<T>&, const CollisionInfo<T>*); \
+		template Ray<T> GetRefractionRay<T>(const Ray<T>&, const CollisionInfo<T>*);
+
+		RAYMGR_INSTANTIATE(float)
+		RAYMGR_INSTANTIATE(double)
+#undef RAYMGR_INSTANTIATE
+
 	}; // namespace RayMgr
 
 }; // namespace Renderer
@@ -3,32 +3,60 @@
 //! Central component for rendering logic
 //! 
 #include "Renderer.h"
+#include <chrono>
 
 
 
 namespace Renderer {
 
+	//! _Halton
+	//! Returns the given element of the Halton sequence of the given base, in [0, 1)
+	//! 
+	static double _Halton(int index, int base) {
+		double value = 0;
+		double digitWeight = 1;
+		for (; index > 0; index /= base) {
+			digitWeight /= base;
+			value += (index % base) * digitWeight;
+		}
+		return value;
+	}
+
 	//! Constructor
+	//! Headless renderers never initialize the display, so SDL is not used at runtime
 	//! 
-	Renderer::Renderer(const char* windowTitle, int windowWidth, int windowHeight, std::shared_ptr<Player::Player> player, std::shared_ptr<World::World> world, std::shared_ptr<InputMgr::InputMgr> inputMgr)
-	: window("WindowFrame", windowWidth, windowHeight)
-	, display(windowTitle, windowWidth, windowHeight, player, world, inputMgr)
+	Renderer::Renderer(const char* windowTitle, int windowWidth, int windowHeight, std::shared_ptr<Player::Player> player, std::shared_ptr<World::World> world, std::shared_ptr<InputMgr::InputMgr> inputMgr, bool isHeadless)
+	: display(windowTitle, windowWidth, windowHeight, player, world, inputMgr)
 	, world(world)
 	, inputMgr(inputMgr)
-	{}
+	, isHeadless(isHeadless)
+	, windowWidth(windowWidth)
+	, windowHeight(windowHeight)
+	{
+		for (int frameI = 0; frameI < frameBufferCount; frameI++) {
+			frames.push_back(std::make_unique<Frame>("WindowFrame_" + std::to_string(frameI), windowWidth, windowHeight));
+			hdrFrames.push_back(std::make_unique<HdrFrame>("HdrFrame_" + std::to_string(frameI), windowWidth, windowHeight));
+		}
+		isFramePacked.assign(frameBufferCount, true);
+		isFrameInTexture.assign(frameBufferCount, false);
+		renderTarget = frames[renderFrameIdx]->GetView();
+		frameCamera = _SnapshotCamera(player->GetCamera(), windowWidth, windowHeight);
+		tileGrid.Build(windowWidth, windowHeight, defaultTileSize);
+		tileScheduler.Reset(tileGrid);
+	}
 
 	//! Init
-	//! Initializes the renderer to an active state
+	//! Initializes the renderer to an active state, with a display texture for each frame of the ring
 	//! 
 	bool Renderer::Init() {
-		bool success = this->display.Init();
+		bool success = isHeadless || this->display.Init(frameBufferCount);
 
 		if (!success) {
-			Util::Log::Error("Renderer initialization failed");
+			LOG_ERROR("Renderer initialization failed");
 			return false;
 		}
 
-		Util::Log::Info("Renderer initialized successfully");
+		LOG_INFO("Renderer initialized successfully");
 		this->isInitialized = true;
 		return true;
 	}
@@ -37,199 +65,720 @@ namespace Renderer {
 	//! Returns the activity state of the renderer. Establishes readiness for processing commands
 	//! 
 	bool Renderer::IsActive() const {
-		return this->isInitialized && display.IsActive();
+		return this->isInitialized && (isHeadless || display.IsActive());
+	}
+
+	//! IsHeadless
+	//! Returns whether frames are only rendered into memory, without a window
+	//! 
+	bool Renderer::IsHeadless() const {
+		return this->isHeadless;
 	}
 
 	//! ProduceWorldFrame
 	//! Produces a world frame and stores within internal buffers for later rendering
 	//! 
 	void Renderer::ProduceWorldFrame(std::shared_ptr<Player::Player> player) {
-		/* ----------------------------------------------------------------
-		 * Generate rays from given screen frame
-		 * ---------------------------------------------------------------- */
-		std::vector<RayMgr::Ray> rays = GenerateRays(player->GetCamera(), display.GetWidth(), display.GetHeight());
-
+		BeginFrame(player->GetCamera());
 
 		/* ----------------------------------------------------------------
 		 * Calculate total light for each ray
 		 * ---------------------------------------------------------------- */
-		for (int rayIdx = 0; rayIdx < rays.size(); rayIdx++) {
-			RayMgr::Ray& ray = rays[rayIdx];
-			Util::Vector3 color = CalcTotalLight(ray);
+		for (int batchI = 0; batchI < GetTileBatches().size(); batchI++) {
+			RenderTileBatch(batchI);
+		}
 
-			// Set the window pixel
-			int colorAdj = (int)color.x << 6 * 4 | (int)color.y << 4 * 4 | (int)color.z << 2 * 4 | 0xFF;
-			int px = rayIdx % display.GetWidth();
-			int py = rayIdx / display.GetWidth();
-			this->window.SetPixel(px, py, colorAdj);
+		EndFrame();
+	}
+
+	//! BeginFrame
+	//! Snapshots the camera and selects the frame to render into, which is never the one being presented
+	//! The frame and tiles are resized to the current render scale. Tiles may then be rendered concurrently until EndFrame
+	//! Tiles reached after the deadline show the previous frame instead of being traced
+	//! Full size frames are tonemapped straight into their locked display texture, which is unlocked by EndFrame.
+	//! Must be called on the display thread
+	//! In progressive mode, frames of the same view of an unchanged world are jittered within each pixel and averaged;
+	//! any change of the camera, such as movement applied by the input manager, or of the world starts over
+	//! 
+	void Renderer::BeginFrame(const Player::Camera* camera, std::chrono::steady_clock::time_point deadline) {
+		renderFrameIdx = (presentFrameIdx + 1) % frameBufferCount;
+		frameDeadline = deadline;
+		nFallbackTiles.store(0, std::memory_order_relaxed);
+
+		int renderWidth = std::max(1, (int)std::lround(windowWidth * renderScale));
+		int renderHeight = std::max(1, (int)std::lround(windowHeight * renderScale));
+
+		std::unique_ptr<Frame>& frame = frames[renderFrameIdx];
+		if (frame->GetWidth() != renderWidth || frame->GetHeight() != renderHeight) {
+			frame = std::make_unique<Frame>(frame->GetName(), renderWidth, renderHeight);
+			hdrFrames[renderFrameIdx] = std::make_unique<HdrFrame>(hdrFrames[renderFrameIdx]->GetName(), renderWidth, renderHeight);
+		}
+		if (tileGrid.GetFrameWidth() != renderWidth || tileGrid.GetFrameHeight() != renderHeight) {
+			tileGrid.Build(renderWidth, renderHeight, tileGrid.GetTileSize());
+			tileScheduler.Reset(tileGrid);
+		}
+
+		//! The image plane follows the window, so the view is the same at every render scale
+		CameraSnapshot snapshot = _SnapshotCamera(camera, windowWidth, windowHeight);
+		snapshot.frameWidth = renderWidth;
+		snapshot.frameHeight = renderHeight;
+
+		if (isProgressive) {
+			bool isViewUnchanged = _IsSameView(snapshot, frameCamera) && world->GetVersion() == accumulatedWorldVersion;
+			if (!isViewUnchanged || !accumulator.HasSize(renderWidth, renderHeight)) {
+				accumulator.Reset(renderWidth, renderHeight);
+				accumulatedWorldVersion = world->GetVersion();
+			}
+			accumulator.BeginFrame();
+
+			//! The first frame samples pixel centers like a non-progressive frame; later ones spread over the pixel
+			int sampleIdx = accumulator.GetFrameCount() - 1;
+			if (sampleIdx > 0) {
+				snapshot.jitterX = (Util::Real)_Halton(sampleIdx, 2);
+				snapshot.jitterY = (Util::Real)_Halton(sampleIdx, 3);
+			}
+		}
+		frameCamera = snapshot;
+
+		renderTarget = frame->GetView();
+		isFramePacked[renderFrameIdx] = true;
+		isFrameInTexture[renderFrameIdx] = false;
+		if (_CanPresentZeroCopy() && renderWidth == windowWidth && renderHeight == windowHeight) {
+			PixelView textureView = display.LockTexture(renderFrameIdx);
+			if (textureView.pixels != nullptr) {
+				renderTarget = textureView;
+				isFramePacked[renderFrameIdx] = false;
+				isFrameInTexture[renderFrameIdx] = true;
+			}
+		}
+	}
+
+	//! EndFrame
+	//! Marks the frame being rendered as complete; it is presented from the next DisplayFrame
+	//! The tile timings of the frame plan the tiles of the next one. Must be called on the display thread
+	//! 
+	void Renderer::EndFrame() {
+		if (isFrameInTexture[renderFrameIdx]) {
+			display.UnlockTexture(renderFrameIdx);
+		}
+		presentFrameIdx = renderFrameIdx;
+		tileScheduler.Update(tileGrid);
+	}
+
+	//! RenderTile
+	//! Traces the rays of the given tile from the frame camera and stores the resulting colors in the frame being rendered
+	//! Rays are traced in the Morton order of the tile pixels. Their radiance is stored in the HDR frame, averaged
+	//! with the previous frames in progressive mode, then the whole tile is tonemapped into the frame
+	//! 
+	void Renderer::RenderTile(const Tile& tile) {
+		thread_local std::vector<RayMgr::Ray<Util::Real>> tileRays;	// Reused between tiles of each render thread
+		thread_local std::vector<Util::Vector3<Util::Real>> colors;
+		thread_local std::vector<TileGrid::Offset> offsets;
+
+		tileRays.clear();
+		offsets.clear();
+		for (const TileGrid::Offset& offset : tileGrid.GetPixelOrder()) {
+			if (offset.x < tile.width && offset.y < tile.height) {
+				tileRays.push_back(_GenerateRay(frameCamera, tile.x + offset.x, tile.y + offset.y));
+				offsets.push_back(offset);
+			}
+		}
+
+		colors.resize(tileRays.size());
+		CalcTotalLight(tileRays.data(), (int)tileRays.size(), colors.data());
+
+		for (int pixelI = 0; pixelI < offsets.size(); pixelI++) {
+			_StoreRadiance(tile.x + offsets[pixelI].x, tile.y + offsets[pixelI].y, colors[pixelI]);
+		}
+		if (isProgressive) {
+			accumulator.AccumulateRect(*hdrFrames[renderFrameIdx], tile.x, tile.y, tile.width, tile.height);
+		}
+		tonemapper.Apply(*hdrFrames[renderFrameIdx], renderTarget, tile.x, tile.y, tile.width, tile.height);
+	}
+
+	//! RenderTileBatch
+	//! Renders the scheduled tiles of the given batch, recording the time each takes
+	//! Tiles reached after the frame deadline are filled from the previous frame instead
+	//! 
+	void Renderer::RenderTileBatch(int batchIdx) {
+		const TileBatch& batch = tileScheduler.GetBatches()[batchIdx];
+		const std::vector<Tile>& tiles = tileScheduler.GetTiles();
+
+		for (int tileI = batch.firstTile; tileI < batch.firstTile + batch.tileCount; tileI++) {
+			auto startTime = std::chrono::steady_clock::now();
+			if (startTime >= frameDeadline) {
+				_FillFallbackTile(tiles[tileI]);
+				tileScheduler.RecordSkipped(tileI);
+				nFallbackTiles.fetch_add(1, std::memory_order_relaxed);
+				continue;
+			}
+
+			RenderTile(tiles[tileI]);
+			tileScheduler.RecordTime(tileI, std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
 		}
 	}
 
 	//! DisplayFrame
-	//! Forwards the window frame in its current state to the display driver for rendering
+	//! Forwards the most recently completed frame to the display driver for rendering
 	//! 
 	void Renderer::DisplayFrame() {
+		BeginOutput();
+		PrepareOutput(0, windowHeight);
+		PresentFrame();
+	}
+
+	//! BeginOutput
+	//! Selects where PrepareOutput upscales the most recently completed frame to: its locked display texture when
+	//! possible, otherwise the output frame. Must be called on the display thread before PrepareOutput
+	//! 
+	void Renderer::BeginOutput() {
+		const Frame& frame = *frames[presentFrameIdx];
+		if (frame.GetWidth() == windowWidth && frame.GetHeight() == windowHeight) {
+			return;
+		}
+
+		outputTarget = outputFrame->GetView();
+		if (_CanPresentZeroCopy()) {
+			PixelView textureView = display.LockTexture(presentFrameIdx);
+			if (textureView.pixels != nullptr) {
+				outputTarget = textureView;
+				isOutputInTexture = true;
+			}
+		}
+	}
+
+	//! PrepareOutput
+	//! Upscales rows [rowBegin, rowEnd) of the most recently completed frame to the window size, if it was rendered below it
+	//! Disjoint rows may be prepared concurrently, also while the next frame renders
+	//! 
+	void Renderer::PrepareOutput(int rowBegin, int rowEnd) {
+		const Frame& frame = *frames[presentFrameIdx];
+		if (frame.GetWidth() != windowWidth || frame.GetHeight() != windowHeight) {
+			Frame::Resample(frame, outputTarget, rowBegin, rowEnd);
+		}
+	}
+
+	//! PresentFrame
+	//! Polls input and presents the most recently completed frame, once its output rows are prepared
+	//! 
+	void Renderer::PresentFrame() {
+		if (isHeadless) {
+			return;
+		}
+
+		//! Frames already in their display texture are rendered from it without a copy
+		bool isInTexture = isOutputInTexture;
+		if (isOutputInTexture) {
+			display.UnlockTexture(presentFrameIdx);
+			isOutputInTexture = false;
+		}
+
 		// TODO: Parameterize/Separate
 		display.PollEvents();
 		inputMgr->ProcessActivityState();	// Process valid activities
-		display.RenderFrame(this->window);
+
+		const Frame& frame = *frames[presentFrameIdx];
+		bool isFullSize = frame.GetWidth() == windowWidth && frame.GetHeight() == windowHeight;
+		if (isInTexture || (isFullSize && isFrameInTexture[presentFrameIdx])) {
+			display.RenderTexture(presentFrameIdx);
+		}
+		else {
+			display.RenderFrame(isFullSize ? frame : *outputFrame, presentFrameIdx);
+		}
 		SDL_Delay(1 / 360);
 	}
 
 	//! CalcTotalLight
 	//! Returns the total resultant light provided by the given ray trace
 	//! 
-	Util::Vector3<double> Renderer::CalcTotalLight(const RayMgr::Ray& ray) const {
-		return _CalcTotalLightHelper(ray, 0);
+	Util::Vector3<Util::Real> Renderer::CalcTotalLight(const RayMgr::Ray<Util::Real>& ray) const {
+		Util::Vector3<Util::Real> color;
+		CalcTotalLight(&ray, 1, &color);
+		return color;
+	}
+
+	//! CalcTotalLight
+	//! Returns the total resultant light of each of the given rays
+	//! Rays are traced as a wavefront: every path of a bounce is intersected, then shaded, and the shading
+	//! stage emits the paths of the next bounce weighted by their throughput. Shadow rays of all paths
+	//! are tested together once shading is complete
+	//! 
+	void Renderer::CalcTotalLight(const RayMgr::Ray<Util::Real>* rays, int count, Util::Vector3<Util::Real>* colors) const {
+		thread_local Wavefront wavefront;	// Reused between calls of each render thread
+
+		for (int firstRay = 0; firstRay < count; firstRay += maxWavefrontSize) {
+			int waveSize = std::min(maxWavefrontSize, count - firstRay);
+
+			//! Seed the primary paths
+			wavefront.paths.Clear();
+			for (int rayI = 0; rayI < waveSize; rayI++) {
+				wavefront.paths.Push(rays[firstRay + rayI], Util::Vector3<Util::Real>(1, 1, 1), rayI);
+				colors[firstRay + rayI] = { 0,0,0 };
+			}
+
+			for (int depth = 0; depth <= maxRayDepth && wavefront.paths.GetCount() > 0; depth++) {
+				if (depth > 0 && useRaySorting) {
+					_SortPaths(wavefront);
+				}
+				_IntersectPaths(wavefront, depth);
+				_BinCollisions(wavefront);
+				_ShadePaths(wavefront, depth);
+				_TraceShadows(wavefront, &colors[firstRay]);
+
+				std::swap(wavefront.paths, wavefront.nextPaths);
+			}
+		}
 	}
 
 	//! GetRawFrame
-	//! Returns the raw window frame for external modification
+	//! Returns the most recently completed frame, at the render resolution it was produced with
+	//! Frames tonemapped straight into their display texture are tonemapped into the frame on first access
 	//! 
 	Frame* Renderer::GetRawFrame() {
-		return &window;
+		Frame& frame = *frames[presentFrameIdx];
+		if (!isFramePacked[presentFrameIdx]) {
+			tonemapper.Apply(*hdrFrames[presentFrameIdx], frame.GetView(), 0, 0, frame.GetWidth(), frame.GetHeight());
+			isFramePacked[presentFrameIdx] = true;
+		}
+		return &frame;
+	}
+
+	//! GetRawHdrFrame
+	//! Returns the linear radiance of the most recently completed frame, at the render resolution it was produced with
+	//! 
+	HdrFrame* Renderer::GetRawHdrFrame() {
+		return hdrFrames[presentFrameIdx].get();
 	}
 
-	//! _CalcTotalLightHelper
-	//! Helper function for CalcTotalLight
+	//! _SortPaths
+	//! Reorders the paths of the current bounce so that rays with similar directions and origins are adjacent
+	//! Paths are keyed by direction octant, then by the Morton code of their origin cell on a 32^3 grid over
+	//! the bounds of all origins, and ordered with a stable two pass radix sort
 	//! 
-	Util::Vector3<double> Renderer::_CalcTotalLightHelper(const RayMgr::Ray& ray, int depth) const {
-		//! Base case
-		if (depth > maxRayDepth) {
-			return { 0,0,0 };	// No light contribution
+	void Renderer::_SortPaths(Wavefront& wavefront) const {
+		PathQueue& paths = wavefront.paths;
+		int nPaths = paths.GetCount();
+		if (nPaths < 2) {
+			return;
+		}
+
+		//! Quantize origins to cells over their bounds
+		Util::AABB<Util::Real> originBounds;
+		for (const RayMgr::Ray<Util::Real>& ray : paths.rays) {
+			originBounds.Grow(ray.origin);
 		}
 
-		//! Get first collision
-		std::unique_ptr<RayMgr::CollisionInfo> firstCol = RayMgr::GetFirstCollision(*world, ray);
+		const Util::Vector3<Util::Real> extent = originBounds.Extent();
+		auto quantize = [](Util::Real offset, Util::Real extent) -> uint32_t {
+			Util::Real cell = (extent > 0) ? offset / extent * 31 : 0;
+			return (cell >= 0) ? (uint32_t)std::min(cell, Util::Real(31)) : 0;	// Also maps NaN to 0
+		};
+
+		std::vector<std::pair<uint32_t, int>>& keys = wavefront.sortKeys;
+		std::vector<std::pair<uint32_t, int>>& scratch = wavefront.sortScratch;
+		keys.resize(nPaths);
+		scratch.resize(nPaths);
+		for (int pathI = 0; pathI < nPaths; pathI++) {
+			const RayMgr::Ray<Util::Real>& ray = paths.rays[pathI];
+			uint32_t octant = (ray.direction.x < 0 ? 1 : 0) | (ray.direction.y < 0 ? 2 : 0) | (ray.direction.z < 0 ? 4 : 0);
+			uint32_t morton = Util::MortonEncode3(
+				quantize(ray.origin.x - originBounds.min.x, extent.x),
+				quantize(ray.origin.y - originBounds.min.y, extent.y),
+				quantize(ray.origin.z - originBounds.min.z, extent.z));
+
+			keys[pathI] = { (octant << 15) | morton, pathI };
+		}
+
+		//! 18 bit keys sorted 9 bits per pass; stable, so ties keep their bounce order
+		constexpr int radixBits = 9;
+		constexpr int radixSize = 1 << radixBits;
+		std::vector<int>& counts = wavefront.sortCounts;
+		for (int shift = 0; shift < 2 * radixBits; shift += radixBits) {
+			counts.assign(radixSize, 0);
+			for (const std::pair<uint32_t, int>& key : keys) {
+				counts[(key.first >> shift) & (radixSize - 1)]++;
+			}
+
+			int offset = 0;
+			for (int& count : counts) {
+				int binSize = count;
+				count = offset;
+				offset += binSize;
+			}
 
-		if (firstCol == nullptr) {
-			// No further contribution
-			return { 0,0,0 };
+			for (const std::pair<uint32_t, int>& key : keys) {
+				scratch[counts[(key.first >> shift) & (radixSize - 1)]++] = key;
+			}
+			keys.swap(scratch);
 		}
-		
-		//! Get object's light properties
-		double pctRefl = firstCol->object->GetMaterial().reflectivity;
-		double pctRefr = firstCol->object->GetMaterial().transparency;
-		double pctDiff = 1 - pctRefl - pctRefr;
 
-		if (pctDiff < 0) {
-			Util::Log::Error("Renderer: Invalid object properties. Sum of reflectivity and transparency must be at most 1.0");
-			return { 0,0,0 };
+		PathQueue& sorted = wavefront.sortedPaths;
+		sorted.Clear();
+		for (const std::pair<uint32_t, int>& key : keys) {
+			sorted.Push(paths.rays[key.second], paths.throughput[key.second], paths.colorIdx[key.second]);
 		}
+		std::swap(paths, sorted);
+	}
 
-		//! Get coincident rays
-		std::vector<RayMgr::Ray> rayDiffs = GetDiffuseRays(firstCol.get());  
-		RayMgr::Ray rayRefl = GetReflectionRay(ray, firstCol.get());
-		RayMgr::Ray rayRefr = GetRefractionRay(ray, firstCol.get());
-		
-		// TODO: return early if max depth
-		// TODO: only spawn ray if light property allows it
+	//! _IntersectPaths
+	//! Resolves the nearest collision of every path of the current bounce
+	//! 
+	void Renderer::_IntersectPaths(Wavefront& wavefront, int depth) const {
+		const PathQueue& paths = wavefront.paths;
+		wavefront.collisions.resize(paths.GetCount());
+
+		if (depth == 0 && usePacketTracing) {
+			//! Primary rays are coherent; trace consecutive rays as packets
+			for (int pathI = 0; pathI < paths.GetCount(); pathI += Util::RayPacket::maxSize) {
+				int packetSize = std::min(Util::RayPacket::maxSize, paths.GetCount() - pathI);
+				RayMgr::GetFirstCollisions(*world, &paths.rays[pathI], packetSize, &wavefront.collisions[pathI]);
+			}
+			return;
+		}
 
-		/* ----------------------------------------------------------------
-		 * Get component light
-		 * ---------------------------------------------------------------- */
-		//! Diffuse
-		// TODO: functionize this
-		std::vector<Util::Vector3<double>> diffuseComps(rayDiffs.size());
-		for (int lightI = 0; lightI < diffuseComps.size(); lightI++) {
-			//! Calculate diffuse due to given light
-			const RayMgr::Ray& diffuseRay = rayDiffs[lightI];
-
-			//! Color material if light is reached
-			std::unique_ptr<RayMgr::CollisionInfo> diffuseCol = RayMgr::GetFirstCollision(*world, diffuseRay);
-			if (diffuseCol == nullptr) {	// TODO: Bad check, need to check if light is collided with (in case something is behind the light). Make light an object to make collision info check simply "isLight?"
-				// Not obscured by an object before reaching light
-				// FIXME: Diffuse collisions with transparent objects allows light to pass through
-
-				//! Calculate intensity
-				double intensity = std::max(0.0, firstCol->normal.Dot(diffuseRay.direction));
-
-				// TODO: Calculate light falloff
-				// TODO: add light color
-
-				//! Calculate color
-				diffuseComps[lightI] = firstCol->object->GetMaterial().color * intensity;
-			}
-			else {
-				diffuseComps[lightI] = { 0,0,0 };
-			}
-		}
-		
-		firstCol.reset();
-
-		// Sum diffuse light contributions
-		// TODO: add HDR rendering for exceeding 255 intensity
-		Util::Vector3<double> colDiff = { 0,0,0 };
-		for (int lightI = 0; lightI < diffuseComps.size(); lightI++) {
-			colDiff = colDiff + diffuseComps[lightI];
-		}
-		
-		//! Reflection and refraction
-		Util::Vector3<double> colRefl = _CalcTotalLightHelper(rayRefl, depth + 1);
-		Util::Vector3<double> colRefr = _CalcTotalLightHelper(rayRefr, depth + 1);
-		
-		/* ----------------------------------------------------------------
-		 * Get total light
-		 * ---------------------------------------------------------------- */
-		Util::Vector3<double> totalLight = (colDiff * pctDiff) + (colRefl * pctRefl) + (colRefr * pctRefr);
-		
-		return totalLight;
+		//! Secondary rays diverge too far for packets to pay off even when sorted; trace them individually
+		for (int pathI = 0; pathI < paths.GetCount(); pathI++) {
+			wavefront.collisions[pathI] = RayMgr::GetFirstCollision(*world, paths.rays[pathI]);
+		}
 	}
 
-	//! GenerateRays
-	//! Generates a list of rays from the given camera properties and frame size
+	//! _BinCollisions
+	//! Determines the shading order of the paths that found a collision
+	//! With material binning, paths are grouped by the material they hit so that shading works on one material at a time
 	//! 
-	std::vector<RayMgr::Ray> Renderer::GenerateRays(const Player::Camera* camera, int frameWidth, int frameHeight) {
-		/* ----------------------------------------------------------------
-		 * Get camera FRU vector information
-		 * ---------------------------------------------------------------- */
-		const Player::Camera::FRUVector& fruVector = camera->GetFRUVector();
-		const Util::Vector3<double>& camForward = fruVector.forward;
-		const Util::Vector3<double>& camRight = fruVector.right;
-		const Util::Vector3<double>& camUp = fruVector.up;
+	void Renderer::_BinCollisions(Wavefront& wavefront) const {
+		std::vector<int>& order = wavefront.shadeOrder;
+		order.clear();
+
+		int nPaths = wavefront.paths.GetCount();
+		if (!useMaterialBinning) {
+			for (int pathI = 0; pathI < nPaths; pathI++) {
+				if (wavefront.collisions[pathI]) {
+					order.push_back(pathI);
+				}
+			}
+			return;
+		}
 
-		/* ----------------------------------------------------------------
-		 * Generate rays
-		 * ---------------------------------------------------------------- */
-		std::vector<RayMgr::Ray> rays(frameWidth * frameHeight);
+		//! Counting sort by material ID, stable within each bin
+		std::vector<int>& binStarts = wavefront.binStarts;
+		binStarts.clear();
+		for (int pathI = 0; pathI < nPaths; pathI++) {
+			if (wavefront.collisions[pathI]) {
+				int binIdx = (int)wavefront.collisions[pathI]->object->GetMaterialID();
+				if (binIdx + 2 > binStarts.size()) {
+					binStarts.resize(binIdx + 2, 0);
+				}
+				binStarts[binIdx + 1]++;
+			}
+		}
+		for (int binI = 1; binI < binStarts.size(); binI++) {
+			binStarts[binI] += binStarts[binI - 1];
+		}
+
+		order.resize(binStarts.empty() ? 0 : binStarts.back());
+		for (int pathI = 0; pathI < nPaths; pathI++) {
+			if (wavefront.collisions[pathI]) {
+				int binIdx = (int)wavefront.collisions[pathI]->object->GetMaterialID();
+				order[binStarts[binIdx]++] = pathI;
+			}
+		}
+	}
+
+	//! _ShadePaths
+	//! Splits the light leaving each collision into its diffuse, reflected and refracted parts, in shading order
+	//! Diffuse light is queued as shadow rays; reflection and refraction continue as paths of the next bounce
+	//! 
+	void Renderer::_ShadePaths(Wavefront& wavefront, int depth) const {
+		const PathQueue& paths = wavefront.paths;
+		PathQueue& nextPaths = wavefront.nextPaths;
+		ShadowQueue& shadows = wavefront.shadows;
+		nextPaths.Clear();
+		shadows.Clear();
+
+		const bool canSpawn = depth < maxRayDepth;
+
+		for (int pathI : wavefront.shadeOrder) {
+			const RayMgr::Ray<Util::Real>& ray = paths.rays[pathI];
+			const RayMgr::CollisionInfo<Util::Real>& collision = *wavefront.collisions[pathI];
+			const Util::Vector3<Util::Real>& throughput = paths.throughput[pathI];
+			const MaterialMgr::Material& material = collision.object->GetMaterial();
+
+			//! Get object's light properties
+			Util::Real pctRefl = (Util::Real)material.reflectivity;
+			Util::Real pctRefr = (Util::Real)material.transparency;
+			Util::Real pctDiff = 1 - pctRefl - pctRefr;
+
+			if (pctDiff < 0) {
+				LOG_ERROR("Renderer: Invalid object properties. Sum of reflectivity and transparency must be at most 1.0");
+				continue;
+			}
+
+			//! Diffuse; only rays towards lights that can contribute are queued
+			if (pctDiff > 0) {
+				int firstShadow = shadows.GetCount();
+				RayMgr::GetDiffuseRays(&collision, shadows.rays);
+
+				for (int shadowI = firstShadow; shadowI < shadows.GetCount(); shadowI++) {
+					// TODO: Calculate light falloff
+					// TODO: add light color
+					Util::Real intensity = std::max(Util::Real(0), collision.normal.Dot(shadows.rays[shadowI].ray.direction));
+					shadows.contribution.push_back(throughput.Multiply((Util::Vector3<Util::Real>(material.color) * intensity) * pctDiff));
+					shadows.colorIdx.push_back(paths.colorIdx[pathI]);
+				}
+			}
 
-		double halfWidth = tan((camera->GetFOV() * Util::PI / 180) / 2);
-		double aspectRatio = frameWidth / frameHeight;
-		double halfHeight = halfWidth / aspectRatio;
+			//! Reflection and refraction, spawned only where the material passes light on
+			if (canSpawn && pctRefl > 0) {
+				nextPaths.Push(RayMgr::GetReflectionRay(ray, &collision), throughput * pctRefl, paths.colorIdx[pathI]);
+			}
+			if (canSpawn && pctRefr > 0) {
+				nextPaths.Push(RayMgr::GetRefractionRay(ray, &collision), throughput * pctRefr, paths.colorIdx[pathI]);
+			}
+		}
+	}
 
-		int rayIdx = 0;
-		for (int py = 0; py < frameHeight; py++) {
-			for (int px = 0; px < frameWidth; px++) {
-				//! Normalize pixels to UV [-1,1]
-				double u = ((px + 0.5) / frameWidth) * 2 - 1;
-				double v = ((py + 0.5) / frameHeight) * 2 - 1;
+	//! _TraceShadows
+	//! Adds the contribution of every queued shadow ray that reaches its light
+	//! 
+	void Renderer::_TraceShadows(Wavefront& wavefront, Util::Vector3<Util::Real>* colors) const {
+		const ShadowQueue& shadows = wavefront.shadows;
 
-				//! Scale UV by half the screen size
-				double x = u * halfWidth;
-				double y = v * halfHeight;
+		for (int shadowI = 0; shadowI < shadows.GetCount(); shadowI++) {
+			const RayMgr::DiffuseRay<Util::Real>& diffuseRay = shadows.rays[shadowI];
 
-				//! Construct the ray
-				rays[rayIdx].origin = camera->GetPosition();
-				rays[rayIdx].direction = (x * camRight + y * camUp + camForward).Normalized();
-				rayIdx++;
+			// FIXME: Diffuse collisions with transparent objects allows light to pass through
+			if (!RayMgr::IsOccluded(*world, diffuseRay.ray, diffuseRay.lightDistance)) {
+				Util::Vector3<Util::Real>& color = colors[shadows.colorIdx[shadowI]];
+				color = color + shadows.contribution[shadowI];
 			}
 		}
+	}
+
+	//! _StoreRadiance
+	//! Stores the given color as linear radiance at the given pixel of the HDR frame being rendered
+	//! The pixel is not bounds checked; callers only store pixels of the frame's tiles
+	//! 
+	void Renderer::_StoreRadiance(int px, int py, const Util::Vector3<Util::Real>& color) {
+		HdrFrame& hdrFrame = *hdrFrames[renderFrameIdx];
+		hdrFrame.GetRow(HdrFrame::RED, py)[px] = (float)(color.x * radianceScale);
+		hdrFrame.GetRow(HdrFrame::GREEN, py)[px] = (float)(color.y * radianceScale);
+		hdrFrame.GetRow(HdrFrame::BLUE, py)[px] = (float)(color.z * radianceScale);
+	}
+
+	//! _FillFallbackTile
+	//! Fills the given tile of the frame being rendered with the radiance of the previous frame, or with the
+	//! fallback color when the previous frame was rendered at another resolution, and tonemaps it
+	//! The previous pixels are not read back, as they may only exist in a display texture
+	//! 
+	void Renderer::_FillFallbackTile(const Tile& tile) {
+		HdrFrame& hdrFrame = *hdrFrames[renderFrameIdx];
+		const HdrFrame& previous = *hdrFrames[presentFrameIdx];
+		const bool canReuse = presentFrameIdx != renderFrameIdx && previous.GetWidth() == hdrFrame.GetWidth() && previous.GetHeight() == hdrFrame.GetHeight();
+
+		if (canReuse) {
+			hdrFrame.CopyRect(previous, tile.x, tile.y, tile.width, tile.height);
+		}
+		else {
+			hdrFrame.FillRect(tile.x, tile.y, tile.width, tile.height, (fallbackColor >> 24) / 255.0f, ((fallbackColor >> 16) & 0xFF) / 255.0f, ((fallbackColor >> 8) & 0xFF) / 255.0f);
+		}
+		tonemapper.Apply(hdrFrame, renderTarget, tile.x, tile.y, tile.width, tile.height);
+	}
+
+	//! _CanPresentZeroCopy
+	//! Returns whether frames may be written straight into display textures
+	//! 
+	bool Renderer::_CanPresentZeroCopy() const {
+		return useZeroCopyPresent && !isHeadless && display.IsActive();
+	}
+
+	//! _SnapshotCamera
+	//! Captures the camera FRU vectors and image plane extent for the given frame size
+	//! 
+	CameraSnapshot Renderer::_SnapshotCamera(const Player::Camera* camera, int frameWidth, int frameHeight) {
+		const Player::Camera::FRUVector& fruVector = camera->GetFRUVector();
+
+		CameraSnapshot snapshot;
+		snapshot.forward = Util::Vector3<Util::Real>(fruVector.forward);
+		snapshot.right = Util::Vector3<Util::Real>(fruVector.right);
+		snapshot.up = Util::Vector3<Util::Real>(fruVector.up);
+		snapshot.position = Util::Vector3<Util::Real>(camera->GetPosition());
+		snapshot.frameWidth = frameWidth;
+		snapshot.frameHeight = frameHeight;
+
+		snapshot.halfWidth = (Util::Real)tan((camera->GetFOV() * Util::PI / 180) / 2);
+		Util::Real aspectRatio = frameWidth / frameHeight;
+		snapshot.halfHeight = snapshot.halfWidth / aspectRatio;
+		return snapshot;
+	}
 
-		return rays;
+	//! _IsSameView
+	//! Returns whether the snapshots see the same view at the same frame size, regardless of their jitter
+	//! 
+	bool Renderer::_IsSameView(const CameraSnapshot& a, const CameraSnapshot& b) {
+		auto isSame = [](const Util::Vector3<Util::Real>& u, const Util::Vector3<Util::Real>& v) {
+			return u.x == v.x && u.y == v.y && u.z == v.z;
+		};
+		return isSame(a.position, b.position) && isSame(a.forward, b.forward) && isSame(a.right, b.right) && isSame(a.up, b.up)
+			&& a.halfWidth == b.halfWidth && a.halfHeight == b.halfHeight
+			&& a.frameWidth == b.frameWidth && a.frameHeight == b.frameHeight;
+	}
+
+	//! _GenerateRay
+	//! Generates the ray through the jitter position of the given pixel, its center unless progressive
+	//! 
+	RayMgr::Ray<Util::Real> Renderer::_GenerateRay(const CameraSnapshot& snapshot, int px, int py) {
+		//! Normalize pixels to UV [-1,1]
+		Util::Real u = ((px + snapshot.jitterX) / snapshot.frameWidth) * 2 - 1;
+		Util::Real v = ((py + snapshot.jitterY) / snapshot.frameHeight) * 2 - 1;
+
+		//! Scale UV by half the screen size
+		Util::Real x = u * snapshot.halfWidth;
+		Util::Real y = v * snapshot.halfHeight;
+
+		//! Construct the ray
+		RayMgr::Ray<Util::Real> ray;
+		ray.origin = snapshot.position;
+		ray.direction = (x * snapshot.right + y * snapshot.up + snapshot.forward).Normalized();
+		return ray;
 	}
 
 	//! GetWindowWidth
 	//! Returns the width of the window in pixels
 	//! 
 	int Renderer::GetWindowWidth() const {
-		return window.GetWidth();
+		return windowWidth;
 	}
 
 	//! GetWindowHeight
 	//! Returns the height of the window in pixels
 	//! 
 	int Renderer::GetWindowHeight() const {
-		return window.GetHeight();
+		return windowHeight;
+	}
+
+	//! GetRenderWidth
+	//! Returns the width in pixels of the frame being rendered
+	//! 
+	int Renderer::GetRenderWidth() const {
+		return frames[renderFrameIdx]->GetWidth();
+	}
+
+	//! GetRenderHeight
+	//! Returns the height in pixels of the frame being rendered
+	//! 
+	int Renderer::GetRenderHeight() const {
+		return frames[renderFrameIdx]->GetHeight();
+	}
+
+	//! GetRenderScale
+	//! Returns the render resolution as a fraction of the window size per axis
+	//! 
+	double Renderer::GetRenderScale() const {
+		return renderScale;
+	}
+
+	//! SetRenderScale
+	//! Sets the render resolution as a fraction of the window size per axis, applied from the next BeginFrame
+	//! Must not be called while rendering
+	//! 
+	void Renderer::SetRenderScale(double scale) {
+		if (!(scale > 0 && scale <= 1)) {
+			LOG_WARN("Renderer: Invalid render scale " + std::to_string(scale) + "; keeping " + std::to_string(renderScale));
+			return;
+		}
+
+		//! Frames below the window size are presented through the output frame
+		if (scale < 1 && !outputFrame) {
+			outputFrame = std::make_unique<Frame>("OutputFrame", windowWidth, windowHeight);
+			outputTarget = outputFrame->GetView();
+		}
+		renderScale = scale;
+	}
+
+	//! GetTiles
+	//! Returns the tiles covering the frame being rendered in the order they should be issued
+	//! 
+	const std::vector<Tile>& Renderer::GetTiles() const {
+		return tileScheduler.GetTiles();
+	}
+
+	//! GetTileBatches
+	//! Returns the batches of tiles covering the frame being rendered in the order they should be issued
+	//! 
+	const std::vector<TileBatch>& Renderer::GetTileBatches() const {
+		return tileScheduler.GetBatches();
+	}
+
+	//! GetTileSize
+	//! Returns the edge length of the render tiles in pixels
+	//! 
+	int Renderer::GetTileSize() const {
+		return tileGrid.GetTileSize();
+	}
+
+	//! SetTileSize
+	//! Sets the edge length of the render tiles in pixels, from 1 to maxTileSize. Must not be called while rendering
+	//! 
+	void Renderer::SetTileSize(int tileSize) {
+		if (tileSize < 1 || tileSize > maxTileSize) {
+			LOG_WARN("Renderer: Invalid tile size " + std::to_string(tileSize) + "; keeping " + std::to_string(tileGrid.GetTileSize()));
+			return;
+		}
+
+		tileGrid.Build(tileGrid.GetFrameWidth(), tileGrid.GetFrameHeight(), tileSize);
+		tileScheduler.Reset(tileGrid);
+	}
+
+	//! SetTileOrder
+	//! Sets the order tile batches are issued in. Must not be called while rendering
+	//! 
+	void Renderer::SetTileOrder(TileOrder order) {
+		tileScheduler.SetOrder(order, tileGrid);
+	}
+
+	//! GetFallbackTileCount
+	//! Returns the number of tiles of the last frame that missed its deadline and show the previous frame
+	//! 
+	int Renderer::GetFallbackTileCount() const {
+		return nFallbackTiles.load(std::memory_order_relaxed);
+	}
+
+	//! GetTonemapSettings
+	//! Returns how radiance is mapped to display pixels
+	//! 
+	const TonemapSettings& Renderer::GetTonemapSettings() const {
+		return tonemapper.GetSettings();
+	}
+
+	//! SetTonemapSettings
+	//! Sets how radiance is mapped to display pixels, applied from the next frame. Must not be called while rendering
+	//! 
+	void Renderer::SetTonemapSettings(const TonemapSettings& settings) {
+		tonemapper.SetSettings(settings);
+	}
+
+	//! IsProgressive
+	//! Returns whether frames of an unchanged view are averaged
+	//! 
+	bool Renderer::IsProgressive() const {
+		return isProgressive;
+	}
+
+	//! SetProgressive
+	//! Sets whether frames of an unchanged view are jittered and averaged into an anti-aliased image
+	//! Accumulation starts over with the next frame. Must not be called while rendering
+	//! 
+	void Renderer::SetProgressive(bool isProgressive) {
+		this->isProgressive = isProgressive;
+		accumulator.Clear();
+	}
+
+	//! GetAccumulatedFrameCount
+	//! Returns the number of frames averaged into the frame being rendered, including it; 0 unless progressive
+	//! 
+	int Renderer::GetAccumulatedFrameCount() const {
+		return isProgressive ? accumulator.GetFrameCount() : 0;
 	}
 
 }; // namespace Renderer
\ No newline at end of file
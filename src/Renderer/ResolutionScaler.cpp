@@ -0,0 +1,62 @@
+//!
+//! ResolutionScaler.cpp
+//! Frame time driven control of the internal render resolution
+//! 
+#include "ResolutionScaler.h"
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace Renderer {
+
+	//! Constructor
+	//! 
+	ResolutionScaler::ResolutionScaler(double frameTimeBudget, double minScale)
+		: frameTimeBudget(frameTimeBudget)
+		, minScale(minScale)
+	{}
+
+	//! AddFrameTime
+	//! Accounts for the duration of the last frame and updates the scale for the next one
+	//! 
+	void ResolutionScaler::AddFrameTime(double seconds) {
+		if (!IsEnabled() || !(seconds > 0)) {
+			return;
+		}
+
+		smoothedFrameTime = (smoothedFrameTime > 0) ? smoothedFrameTime + smoothing * (seconds - smoothedFrameTime) : seconds;
+		double load = smoothedFrameTime / frameTimeBudget;
+		if (load <= 1 && load >= headroomLoad) {
+			return;
+		}
+
+		if (load < headroomLoad && scale >= 1) {
+			return;
+		}
+
+		//! Cost scales with the pixel count, so the scale per axis moves with the square root of the load
+		double desired = scale * std::sqrt(targetLoad / load);
+		desired = std::clamp(desired, scale * (1 - maxStep), scale * (1 + maxStep));
+		desired = std::clamp(desired, minScale, 1.0);
+
+		double quantized = (desired < scale) ? std::floor(desired / scaleQuantum) * scaleQuantum : std::ceil(desired / scaleQuantum) * scaleQuantum;
+		quantized = std::clamp(quantized, minScale, 1.0);
+
+		//! Predict the frame time at the new scale so the average does not keep pushing in the same direction
+		smoothedFrameTime *= (quantized * quantized) / (scale * scale);
+		scale = quantized;
+	}
+
+	//! SetFrameTimeBudget
+	//! Sets the frame time to maintain in seconds. 0 disables scaling and restores the full resolution
+	//! 
+	void ResolutionScaler::SetFrameTimeBudget(double seconds) {
+		frameTimeBudget = std::max(0.0, seconds);
+		smoothedFrameTime = 0;
+		if (!IsEnabled()) {
+			scale = 1;
+		}
+	}
+
+}; // namespace Renderer
@@ -0,0 +1,63 @@
+//!
+//! TileGrid.cpp
+//! Decomposition of a frame into square tiles of pixels
+//! 
+#include "TileGrid.h"
+#include <algorithm>
+
+
+
+namespace Renderer {
+
+	//! Build
+	//! Rebuilds the tiles for the given frame and tile size
+	//! 
+	void TileGrid::Build(int frameWidth, int frameHeight, int tileSize) {
+		this->frameWidth = frameWidth;
+		this->frameHeight = frameHeight;
+		this->tileSize = tileSize;
+
+		int nTilesX = (frameWidth + tileSize - 1) / tileSize;
+		int nTilesY = (frameHeight + tileSize - 1) / tileSize;
+
+		//! Order the tile grid along the Z-curve; sorting handles grids that are not a power of two
+		std::vector<std::pair<uint32_t, Tile>> keyedTiles;
+		keyedTiles.reserve((size_t)nTilesX * nTilesY);
+		for (int tileY = 0; tileY < nTilesY; tileY++) {
+			for (int tileX = 0; tileX < nTilesX; tileX++) {
+				Tile tile;
+				tile.x = tileX * tileSize;
+				tile.y = tileY * tileSize;
+				tile.width = std::min(tileSize, frameWidth - tile.x);
+				tile.height = std::min(tileSize, frameHeight - tile.y);
+				keyedTiles.push_back({ Util::MortonEncode2(tileX, tileY), tile });
+			}
+		}
+		std::sort(keyedTiles.begin(), keyedTiles.end(), [](const std::pair<uint32_t, Tile>& a, const std::pair<uint32_t, Tile>& b) {
+			return a.first < b.first;
+		});
+
+		tiles.clear();
+		for (const std::pair<uint32_t, Tile>& keyedTile : keyedTiles) {
+			tiles.push_back(keyedTile.second);
+		}
+
+		//! Same ordering for the pixels of a tile
+		std::vector<std::pair<uint32_t, Offset>> keyedPixels;
+		keyedPixels.reserve((size_t)tileSize * tileSize);
+		for (int offsetY = 0; offsetY < tileSize; offsetY++) {
+			for (int offsetX = 0; offsetX < tileSize; offsetX++) {
+				keyedPixels.push_back({ Util::MortonEncode2(offsetX, offsetY), { (uint16_t)offsetX, (uint16_t)offsetY } });
+			}
+		}
+		std::sort(keyedPixels.begin(), keyedPixels.end(), [](const std::pair<uint32_t, Offset>& a, const std::pair<uint32_t, Offset>& b) {
+			return a.first < b.first;
+		});
+
+		pixelOrder.clear();
+		for (const std::pair<uint32_t, Offset>& keyedPixel : keyedPixels) {
+			pixelOrder.push_back(keyedPixel.second);
+		}
+	}
+
+}; // namespace Renderer
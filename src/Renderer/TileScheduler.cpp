@@ -0,0 +1,209 @@
+//!
+//! TileScheduler.cpp
+//! Cost-aware ordering and grouping of render tiles
+//! 
+#include "TileScheduler.h"
+#include <algorithm>
+
+
+
+namespace Renderer {
+
+	//! Reset
+	//! Discards the recorded costs and schedules the grid tiles one tile per batch, in Morton order unless issued center first
+	//! 
+	void TileScheduler::Reset(const TileGrid& grid) {
+		const std::vector<Tile>& gridTiles = grid.GetTiles();
+
+		//! Every cell split in four is the most work a frame can be planned as; reserving it keeps planning allocation free
+		size_t maxTiles = 4 * gridTiles.size();
+		tiles.reserve(maxTiles);
+		tileCells.reserve(maxTiles);
+		batches.reserve(maxTiles);
+		tileTimes.reserve(maxTiles);
+		scratchTiles.reserve(maxTiles);
+		scratchCells.reserve(maxTiles);
+		workItems.reserve(maxTiles);
+
+		cellCosts.assign(gridTiles.size(), 0);
+
+		scratchTiles.clear();
+		scratchCells.clear();
+		workItems.clear();
+		for (int cellI = 0; cellI < gridTiles.size(); cellI++) {
+			_AddItem(0, gridTiles[cellI], cellI);
+		}
+
+		_SortItems(grid);
+		_EmitItems();
+	}
+
+	//! SetOrder
+	//! Sets the order batches are issued in, replanning the current schedule
+	//! 
+	void TileScheduler::SetOrder(TileOrder order, const TileGrid& grid) {
+		this->order = order;
+		Reset(grid);
+	}
+
+	//! Update
+	//! Folds the times recorded this frame into the cell costs and plans the next frame
+	//! Must be called once every scheduled tile of the frame has been rendered
+	//! 
+	void TileScheduler::Update(const TileGrid& grid) {
+		const std::vector<Tile>& gridTiles = grid.GetTiles();
+		if (cellCosts.size() != gridTiles.size()) {
+			Reset(grid);
+			return;
+		}
+
+		/* ----------------------------------------------------------------
+		* Update cell costs
+		* ---------------------------------------------------------------- */
+		//! Split cells were timed in parts; sum them in the scratch array first, counting the parts not rendered
+		workItems.clear();
+		for (int cellI = 0; cellI < cellCosts.size(); cellI++) {
+			workItems.push_back({ 0, cellI, 0 });
+		}
+		for (int tileI = 0; tileI < tiles.size(); tileI++) {
+			if (tileTimes[tileI] < 0) {
+				workItems[tileCells[tileI]].tileCount++;
+			}
+			else {
+				workItems[tileCells[tileI]].cost += tileTimes[tileI];
+			}
+		}
+
+		double totalCost = 0;
+		for (int cellI = 0; cellI < cellCosts.size(); cellI++) {
+			double measured = workItems[cellI].cost;
+			if (workItems[cellI].tileCount == 0) {
+				cellCosts[cellI] = (cellCosts[cellI] > 0) ? cellCosts[cellI] + costSmoothing * (measured - cellCosts[cellI]) : measured;
+			}
+			totalCost += cellCosts[cellI];
+		}
+
+		if (!(totalCost > 0)) {
+			Reset(grid);
+			return;
+		}
+
+		/* ----------------------------------------------------------------
+		* Split expensive cells and merge runs of cheap ones
+		* ---------------------------------------------------------------- */
+		const double meanCost = totalCost / cellCosts.size();
+		scratchTiles.clear();
+		scratchCells.clear();
+		workItems.clear();
+
+		for (int cellI = 0; cellI < gridTiles.size(); cellI++) {
+			double cost = cellCosts[cellI];
+			if (cost > splitFactor * meanCost) {
+				_SplitTile(gridTiles[cellI], cellI, cost);
+			}
+			else if (cost >= mergeFactor * meanCost) {
+				_AddItem(cost, gridTiles[cellI], cellI);
+			}
+		}
+
+		//! Cheap cells are grouped in Morton order, so each batch stays a compact region of the frame
+		WorkItem mergeItem = { 0, (int)scratchTiles.size(), 0 };
+		for (int cellI = 0; cellI < gridTiles.size(); cellI++) {
+			if (cellCosts[cellI] >= mergeFactor * meanCost) {
+				continue;
+			}
+
+			scratchTiles.push_back(gridTiles[cellI]);
+			scratchCells.push_back(cellI);
+			mergeItem.cost += cellCosts[cellI];
+			mergeItem.tileCount++;
+
+			if (mergeItem.cost >= meanCost) {
+				workItems.push_back(mergeItem);
+				mergeItem = { 0, (int)scratchTiles.size(), 0 };
+			}
+		}
+		if (mergeItem.tileCount > 0) {
+			workItems.push_back(mergeItem);
+		}
+
+		_SortItems(grid);
+		_EmitItems();
+	}
+
+	//! _SortItems
+	//! Sorts the planned batches into issue order
+	//! 
+	void TileScheduler::_SortItems(const TileGrid& grid) {
+		if (order == TileOrder::CENTER_FIRST) {
+			//! Doubled coordinates keep the distances integral
+			const int centerX = grid.GetFrameWidth();
+			const int centerY = grid.GetFrameHeight();
+			for (WorkItem& item : workItems) {
+				const Tile& tile = scratchTiles[item.firstTile];
+				int64_t dx = 2 * tile.x + tile.width - centerX;
+				int64_t dy = 2 * tile.y + tile.height - centerY;
+				item.cost = -(double)(dx * dx + dy * dy);
+			}
+		}
+
+		//! Highest key first; ties keep their Morton order
+		std::sort(workItems.begin(), workItems.end(), [](const WorkItem& a, const WorkItem& b) {
+			return (a.cost != b.cost) ? a.cost > b.cost : a.firstTile < b.firstTile;
+		});
+	}
+
+	//! _EmitItems
+	//! Lays out the scheduled tiles and batches in the order of the sorted work items
+	//! 
+	void TileScheduler::_EmitItems() {
+		tiles.clear();
+		tileCells.clear();
+		batches.clear();
+		for (const WorkItem& item : workItems) {
+			batches.push_back({ (int)tiles.size(), item.tileCount });
+			tiles.insert(tiles.end(), scratchTiles.begin() + item.firstTile, scratchTiles.begin() + item.firstTile + item.tileCount);
+			tileCells.insert(tileCells.end(), scratchCells.begin() + item.firstTile, scratchCells.begin() + item.firstTile + item.tileCount);
+		}
+
+		tileTimes.assign(tiles.size(), 0);
+	}
+
+	//! _AddItem
+	//! Schedules the given tile as a batch of its own
+	//! 
+	void TileScheduler::_AddItem(double cost, const Tile& tile, int cellIdx) {
+		workItems.push_back({ cost, (int)scratchTiles.size(), 1 });
+		scratchTiles.push_back(tile);
+		scratchCells.push_back(cellIdx);
+	}
+
+	//! _SplitTile
+	//! Schedules the quadrants of the given tile as batches of their own, sharing the cost of the cell evenly
+	//! Rows are split at multiples of 4 so packets remain square. Columns are only split on a cache line
+	//! boundary of the frame, since parts stolen by different workers must not share a line
+	//! 
+	void TileScheduler::_SplitTile(const Tile& tile, int cellIdx, double cost) {
+		int splitWidth = (tile.x + tile.width / 2 + columnAlignment / 2) / columnAlignment * columnAlignment - tile.x;
+		if (splitWidth <= 0 || splitWidth >= tile.width) {
+			splitWidth = tile.width;
+		}
+		int splitHeight = (tile.height >= minSplitSize) ? ((tile.height / 2 + 3) & ~3) : tile.height;
+
+		int nPartsX = (splitWidth < tile.width) ? 2 : 1;
+		int nPartsY = (splitHeight < tile.height) ? 2 : 1;
+		double partCost = cost / (nPartsX * nPartsY);
+
+		for (int partY = 0; partY < nPartsY; partY++) {
+			for (int partX = 0; partX < nPartsX; partX++) {
+				Tile part;
+				part.x = tile.x + partX * splitWidth;
+				part.y = tile.y + partY * splitHeight;
+				part.width = (partX == 0) ? splitWidth : tile.width - splitWidth;
+				part.height = (partY == 0) ? splitHeight : tile.height - splitHeight;
+				_AddItem(partCost, part, cellIdx);
+			}
+		}
+	}
+
+}; // namespace Renderer
@@ -0,0 +1,100 @@
+//!
+//! Tonemapper.cpp
+//! Converts linear radiance to packed display pixels
+//!
+#include "Tonemapper.h"
+#include <algorithm>
+#include <cmath>
+#include "Simd.h"
+
+
+
+namespace Renderer {
+
+	using Lanes = Util::Simd<float>;
+
+	//! _PackLanes
+	//! Rounds channels already scaled to [0, 255] and stores them as RGBA8888 with full alpha
+	//!
+	static void _PackLanes(Lanes r, Lanes g, Lanes b, uint32_t* dst) {
+#if defined(__AVX2__)
+		__m256i pixels = _mm256_or_si256(_mm256_slli_epi32(_mm256_cvtps_epi32(r.v), 24), _mm256_slli_epi32(_mm256_cvtps_epi32(g.v), 16));
+		pixels = _mm256_or_si256(pixels, _mm256_slli_epi32(_mm256_cvtps_epi32(b.v), 8));
+		pixels = _mm256_or_si256(pixels, _mm256_set1_epi32(0xFF));
+		_mm256_storeu_si256((__m256i*)dst, pixels);
+#else
+		*dst = (uint32_t)std::lrint(r.v) << 24 | (uint32_t)std::lrint(g.v) << 16 | (uint32_t)std::lrint(b.v) << 8 | 0xFF;
+#endif
+	}
+
+	//! GetSettings
+	//! Returns the active tonemapping settings
+	//!
+	const TonemapSettings& Tonemapper::GetSettings() const {
+		return settings;
+	}
+
+	//! SetSettings
+	//! Sets the tonemapping settings, applied to rectangles mapped from then on
+	//!
+	void Tonemapper::SetSettings(const TonemapSettings& settings) {
+		this->settings = settings;
+		this->settings.exposure = std::max(settings.exposure, 0.0f);
+		this->settings.whitePoint = std::max(settings.whitePoint, 1.0f);
+	}
+
+	//! Apply
+	//! Maps the given rectangle of the source into the same rectangle of the target. Both must have the same size
+	//! Disjoint rectangles may be mapped concurrently
+	//!
+	void Tonemapper::Apply(const HdrFrame& source, const PixelView& target, int x, int y, int width, int height) const {
+		if (source.GetWidth() != target.width || source.GetHeight() != target.height) {
+			LOG_WARN("Tonemapper: HDR frame and target sizes differ");
+			return;
+		}
+
+		for (int py = y; py < y + height; py++) {
+			_MapRow(source.GetRow(HdrFrame::RED, py) + x, source.GetRow(HdrFrame::GREEN, py) + x, source.GetRow(HdrFrame::BLUE, py) + x, target.pixels + (size_t)py * target.pitch + x, width);
+		}
+	}
+
+	//! _MapRow
+	//! Maps count consecutive pixels. A partial vector at the end of the row is mapped through a padded copy
+	//!
+	void Tonemapper::_MapRow(const float* r, const float* g, const float* b, uint32_t* dst, int count) const {
+		const Lanes zero(0.0f), one(1.0f), scale(255.0f);
+		const Lanes exposure(settings.exposure);
+		const Lanes invWhiteSq(1.0f / (settings.whitePoint * settings.whitePoint));
+		const bool isReinhard = settings.op == TonemapOperator::REINHARD;
+		const bool encodeGamma = settings.encodeGamma;
+
+		auto map = [&](Lanes value) {
+			value = Max(value * exposure, zero);
+			if (isReinhard) {
+				value = value * (one + value * invWhiteSq) / (one + value);
+			}
+			value = Min(value, one);
+			if (encodeGamma) {
+				value = Sqrt(value);
+			}
+			return value * scale;
+		};
+
+		int pixelI = 0;
+		for (; pixelI + Lanes::width <= count; pixelI += Lanes::width) {
+			_PackLanes(map(Lanes::Load(r + pixelI)), map(Lanes::Load(g + pixelI)), map(Lanes::Load(b + pixelI)), dst + pixelI);
+		}
+
+		if (pixelI < count) {
+			float tail[HdrFrame::CHANNEL_COUNT][Lanes::width] = {};
+			uint32_t tailPixels[Lanes::width];
+			int tailCount = count - pixelI;
+			std::copy(r + pixelI, r + count, tail[HdrFrame::RED]);
+			std::copy(g + pixelI, g + count, tail[HdrFrame::GREEN]);
+			std::copy(b + pixelI, b + count, tail[HdrFrame::BLUE]);
+			_PackLanes(map(Lanes::Load(tail[HdrFrame::RED])), map(Lanes::Load(tail[HdrFrame::GREEN])), map(Lanes::Load(tail[HdrFrame::BLUE])), tailPixels);
+			std::copy(tailPixels, tailPixels + tailCount, dst + pixelI);
+		}
+	}
+
+}; // namespace Renderer
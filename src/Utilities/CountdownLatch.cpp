@@ -0,0 +1,63 @@
+//!
+//! CountdownLatch.cpp
+//! Reusable completion counter that threads can block on
+//! 
+#include "CountdownLatch.h"
+
+
+
+namespace Util {
+
+	//! Constructor
+	//! 
+	CountdownLatch::CountdownLatch(int count)
+		: count(count)
+	{}
+
+	//! Reset
+	//! Rearms the latch with the given count. Must not be called while a thread waits
+	//! 
+	void CountdownLatch::Reset(int count) {
+		this->count.store(count, std::memory_order_release);
+	}
+
+	//! Add
+	//! Raises the count by n for work registered after construction
+	//! 
+	void CountdownLatch::Add(int n) {
+		count.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	//! CountDown
+	//! Lowers the count by n, waking the waiters once it reaches zero
+	//! 
+	void CountdownLatch::CountDown(int n) {
+		int current = count.load(std::memory_order_relaxed);
+		while (current > n) {
+			if (count.compare_exchange_weak(current, current - n, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				return;
+			}
+		}
+
+		//! The final count is taken under the lock, so a waiter can not return while this thread still uses the latch
+		std::lock_guard<std::mutex> lock(mutex);
+		count.fetch_sub(n, std::memory_order_acq_rel);
+		cond.notify_all();
+	}
+
+	//! Wait
+	//! Blocks until the count reaches zero
+	//! 
+	void CountdownLatch::Wait() {
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [&]() { return IsDone(); });
+	}
+
+	//! IsDone
+	//! Returns whether the count has reached zero
+	//! 
+	bool CountdownLatch::IsDone() const {
+		return count.load(std::memory_order_acquire) <= 0;
+	}
+
+}; // namespace Util
@@ -0,0 +1,136 @@
+//!
+//! CpuTopology.cpp
+//! Logical processor layout used to place worker threads
+//! 
+#include "CpuTopology.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+
+
+namespace Util {
+
+	//! _ReadInt
+	//! Reads a single integer from the given file, returning fallback if it can not be read
+	//! 
+	static int _ReadInt(const std::string& path, int fallback) {
+		std::ifstream file(path);
+		int value;
+		return (file >> value) ? value : fallback;
+	}
+
+	//! _ParseCpuList
+	//! Parses a kernel CPU list such as "0-7,16-23" into processor indices
+	//! 
+	static std::vector<int> _ParseCpuList(const std::string& list) {
+		std::vector<int> cpus;
+		const char* cursor = list.c_str();
+		while (*cursor != '\0') {
+			char* next;
+			long first = std::strtol(cursor, &next, 10);
+			if (next == cursor) {
+				break;	// Trailing whitespace or malformed input
+			}
+
+			long last = first;
+			if (*next == '-') {
+				cursor = next + 1;
+				last = std::strtol(cursor, &next, 10);
+			}
+			for (long cpu = first; cpu <= last; cpu++) {
+				cpus.push_back((int)cpu);
+			}
+
+			cursor = (*next == ',') ? next + 1 : next;
+		}
+		return cpus;
+	}
+
+	//! Detect
+	//! Queries the processors the process may run on
+	//! 
+	CpuTopology CpuTopology::Detect() {
+		CpuTopology topology;
+
+#ifdef __linux__
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+			//! NUMA node of each processor, if the kernel exposes nodes
+			std::map<int, int> cpuNode;
+			for (int node = 0; ; node++) {
+				std::ifstream nodeFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+				std::string list;
+				if (!std::getline(nodeFile, list)) {
+					break;
+				}
+				for (int cpu : _ParseCpuList(list)) {
+					cpuNode[cpu] = node;
+				}
+			}
+
+			std::map<std::pair<int, int>, int> coreIdx;		// (package, core id) -> physical core
+			std::map<int, int> coreThreads;					// physical core -> hardware threads seen
+			for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+				if (!CPU_ISSET(cpu, &allowed)) {
+					continue;
+				}
+
+				const std::string topologyDir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+				Processor processor;
+				processor.cpu = cpu;
+				processor.package = std::max(0, _ReadInt(topologyDir + "physical_package_id", 0));
+				int coreId = _ReadInt(topologyDir + "core_id", cpu);
+
+				auto core = coreIdx.emplace(std::make_pair(processor.package, coreId), (int)coreIdx.size()).first;
+				processor.core = core->second;
+				processor.smtRank = coreThreads[processor.core]++;
+
+				auto node = cpuNode.find(cpu);
+				processor.node = (node != cpuNode.end()) ? node->second : processor.package;
+				topology.processors.push_back(processor);
+			}
+		}
+#endif
+
+		if (topology.processors.empty()) {
+			int nCpus = std::max(1u, std::thread::hardware_concurrency());
+			for (int cpu = 0; cpu < nCpus; cpu++) {
+				topology.processors.push_back({ cpu, cpu, 0, 0, 0 });
+			}
+		}
+
+		//! Renumber nodes densely
+		std::map<int, int> nodeIdx;
+		for (Processor& processor : topology.processors) {
+			processor.node = nodeIdx.emplace(processor.node, (int)nodeIdx.size()).first->second;
+		}
+		topology.nodeCount = (int)nodeIdx.size();
+
+		return topology;
+	}
+
+	//! GetPlacementOrder
+	//! Returns the processors in the order workers should occupy them: one hardware thread per physical
+	//! core before any SMT sibling, and within that node by node, so that a partial pool fills one node first
+	//! 
+	std::vector<CpuTopology::Processor> CpuTopology::GetPlacementOrder() const {
+		std::vector<Processor> order = processors;
+		std::stable_sort(order.begin(), order.end(), [](const Processor& a, const Processor& b) {
+			if (a.smtRank != b.smtRank) return a.smtRank < b.smtRank;
+			if (a.node != b.node) return a.node < b.node;
+			return a.core < b.core;
+		});
+		return order;
+	}
+
+}; // namespace Util
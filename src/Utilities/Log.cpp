@@ -3,52 +3,200 @@
 //! Console logging methods
 //! 
 #include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
 
 
 
 
 namespace Util {
 
-	std::mutex Log::mutex;
+	//! LogSink
+	//! Bounded multi-producer ring of log lines drained to the console by a background thread
+	//! Each slot carries a sequence number: producers claim a position with a CAS on the tail and publish
+	//! the slot by advancing its sequence, which the single consumer waits on before reading it
+	//! 
+	class LogSink {
+	private:
+		static constexpr size_t capacity = 1024;	// Power of two
+		static constexpr size_t maxLineLength = 240;
+		static constexpr auto idleInterval = std::chrono::milliseconds(2);
+
+		struct Slot {
+			std::atomic<size_t> sequence;
+			const char* tag;
+			size_t length;
+			bool isTruncated;
+			char text[maxLineLength];
+		};
+
+		std::unique_ptr<Slot[]> slots;
+		alignas(64) std::atomic<size_t> tail;		// Next position to claim
+		alignas(64) std::atomic<size_t> head;		// Next position to drain; written by the drain thread only
+		std::atomic<size_t> nDropped;
+		std::atomic<bool> isStopping;
+		std::thread drainThread;
+
+	public:
+		LogSink()
+			: slots(new Slot[capacity])
+			, tail(0)
+			, head(0)
+			, nDropped(0)
+			, isStopping(false)
+		{
+			for (size_t slotI = 0; slotI < capacity; slotI++) {
+				slots[slotI].sequence.store(slotI, std::memory_order_relaxed);
+			}
+			drainThread = std::thread(&LogSink::_Run, this);
+		}
+
+		~LogSink() {
+			isStopping.store(true, std::memory_order_release);
+			drainThread.join();
+		}
+
+		//! Push
+		//! Queues a line. When the ring is full the line is dropped unless mustDeliver is set, in which case
+		//! the caller waits for the drain thread to make room
+		//! 
+		void Push(const char* tag, const std::string& message, bool mustDeliver) {
+			size_t pos = tail.load(std::memory_order_relaxed);
+			Slot* slot;
+			while (true) {
+				slot = &slots[pos & (capacity - 1)];
+				size_t sequence = slot->sequence.load(std::memory_order_acquire);
+				ptrdiff_t diff = (ptrdiff_t)sequence - (ptrdiff_t)pos;
+
+				if (diff == 0) {
+					if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+						break;
+					}
+				}
+				else if (diff < 0) {
+					//! Full
+					if (!mustDeliver) {
+						nDropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+					std::this_thread::yield();
+					pos = tail.load(std::memory_order_relaxed);
+				}
+				else {
+					pos = tail.load(std::memory_order_relaxed);
+				}
+			}
+
+			slot->tag = tag;
+			slot->length = std::min(message.size(), maxLineLength);
+			slot->isTruncated = message.size() > maxLineLength;
+			std::memcpy(slot->text, message.data(), slot->length);
+			slot->sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		//! Flush
+		//! Waits until every line queued before the call has been written
+		//! 
+		void Flush() {
+			size_t target = tail.load(std::memory_order_acquire);
+			while (head.load(std::memory_order_acquire) < target) {
+				std::this_thread::yield();
+			}
+		}
+
+	private:
+		//! _Run
+		//! Drains the ring until shutdown, then writes whatever is left
+		//! 
+		void _Run() {
+			while (!isStopping.load(std::memory_order_acquire)) {
+				if (!_Drain()) {
+					std::this_thread::sleep_for(idleInterval);
+				}
+			}
+			while (_Drain()) {}
+		}
+
+		//! _Drain
+		//! Writes every published line and flushes the console once. Returns whether anything was written
+		//! 
+		bool _Drain() {
+			size_t pos = head.load(std::memory_order_relaxed);
+			size_t firstPos = pos;
+
+			while (true) {
+				Slot& slot = slots[pos & (capacity - 1)];
+				if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+					break;
+				}
+
+				std::cout << slot.tag;
+				std::cout.write(slot.text, slot.length);
+				std::cout << (slot.isTruncated ? "...\n" : "\n");
+
+				slot.sequence.store(pos + capacity, std::memory_order_release);
+				pos++;
+				head.store(pos, std::memory_order_release);
+			}
+
+			size_t dropped = nDropped.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0) {
+				std::cout << "[WARN] Log: Dropped " << dropped << " messages\n";
+			}
+
+			if (pos == firstPos && dropped == 0) {
+				return false;
+			}
+			std::cout.flush();
+			return true;
+		}
+	};
+
+	//! _GetSink
+	//! Returns the sink, starting its drain thread on first use
+	//! 
+	static LogSink& _GetSink() {
+		static LogSink sink;
+		return sink;
+	}
 
 	//! Info
 	//! Logs message with [INFO] tag
 	//! 
-	void Log::Info(std::string message) {
-		if ((int)logLevel >= 4) {
-			std::lock_guard<std::mutex> lock(mutex);
-			std::cout << "[INFO] " << message << std::endl;
-		}
+	void Log::Info(const std::string& message) {
+		_GetSink().Push("[INFO] ", message, false);
 	}
 
 	//! Debug
 	//! Logs message with [DEBUG] tag
 	//! 
-	void Log::Debug(std::string message) {
-		if ((int)logLevel >= 3) {
-			std::lock_guard<std::mutex> lock(mutex);
-			std::cout << "[DEBUG] " << message << std::endl;
-		}
+	void Log::Debug(const std::string& message) {
+		_GetSink().Push("[DEBUG] ", message, false);
 	}
 
 	//! Warn
 	//! Logs message with [WARN] tag
 	//! 
-	void Log::Warn(std::string message) {
-		if ((int)logLevel >= 2) {
-			std::lock_guard<std::mutex> lock(mutex);
-			std::cout << "[WARN] " << message << std::endl;
-		}
+	void Log::Warn(const std::string& message) {
+		_GetSink().Push("[WARN] ", message, false);
 	}
 
 	//! Error
-	//! Logs message with [ERROR] tag
+	//! Logs message with [ERROR] tag. Errors are never dropped
 	//! 
-	void Log::Error(std::string message) {
-		if ((int)logLevel >= 1) {
-			std::lock_guard<std::mutex> lock(mutex);
-			std::cout << "[ERROR] " << message << std::endl;
-		}
+	void Log::Error(const std::string& message) {
+		_GetSink().Push("[ERROR] ", message, true);
+	}
+
+	//! Flush
+	//! Blocks until every message logged so far has been written to the console
+	//! 
+	void Log::Flush() {
+		_GetSink().Flush();
 	}
 
-}; // namespace Util
\ No newline at end of file
+}; // namespace Util
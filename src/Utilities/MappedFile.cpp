@@ -0,0 +1,144 @@
+//!
+//! MappedFile.cpp
+//! Read-only memory mapping of a file
+//! 
+#include "MappedFile.h"
+#include "Log.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace Util {
+
+	//! Destructor
+	//! 
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	//! Open
+	//! Maps the entire file at the given path into memory for reading
+	//! Pages are loaded lazily by the OS as they are first accessed
+	//! 
+	bool MappedFile::Open(const std::string& path) {
+		Close();
+
+#ifdef _WIN32
+		fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (fileHandle == INVALID_HANDLE_VALUE) {
+			fileHandle = nullptr;
+			LOG_ERROR("MappedFile: Failed to open " + path);
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize)) {
+			LOG_ERROR("MappedFile: Failed to query size of " + path);
+			Close();
+			return false;
+		}
+
+		size = (std::size_t)fileSize.QuadPart;
+		if (size == 0) {
+			return true;	// Empty files cannot be mapped
+		}
+
+		mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mappingHandle == nullptr) {
+			LOG_ERROR("MappedFile: Failed to create mapping of " + path);
+			Close();
+			return false;
+		}
+
+		data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (data == nullptr) {
+			LOG_ERROR("MappedFile: Failed to map " + path);
+			Close();
+			return false;
+		}
+#else
+		fileDescriptor = open(path.c_str(), O_RDONLY);
+		if (fileDescriptor == -1) {
+			LOG_ERROR("MappedFile: Failed to open " + path);
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(fileDescriptor, &fileStat) == -1) {
+			LOG_ERROR("MappedFile: Failed to query size of " + path);
+			Close();
+			return false;
+		}
+
+		size = (std::size_t)fileStat.st_size;
+		if (size == 0) {
+			return true;	// Empty files cannot be mapped
+		}
+
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (mapping == MAP_FAILED) {
+			LOG_ERROR("MappedFile: Failed to map " + path);
+			Close();
+			return false;
+		}
+
+		madvise(mapping, size, MADV_SEQUENTIAL);	// Parsers stream front to back
+		data = static_cast<const char*>(mapping);
+#endif
+
+		return true;
+	}
+
+	//! Close
+	//! Unmaps the file, invalidating any pointers into its data
+	//! 
+	void MappedFile::Close() {
+#ifdef _WIN32
+		if (data != nullptr) {
+			UnmapViewOfFile(data);
+		}
+		if (mappingHandle != nullptr) {
+			CloseHandle(mappingHandle);
+		}
+		if (fileHandle != nullptr) {
+			CloseHandle(fileHandle);
+		}
+		mappingHandle = nullptr;
+		fileHandle = nullptr;
+#else
+		if (data != nullptr) {
+			munmap(const_cast<char*>(data), size);
+		}
+		if (fileDescriptor != -1) {
+			close(fileDescriptor);
+		}
+		fileDescriptor = -1;
+#endif
+
+		data = nullptr;
+		size = 0;
+	}
+
+	//! Accessors
+	//! 
+	bool MappedFile::IsOpen() const {
+#ifdef _WIN32
+		return fileHandle != nullptr;
+#else
+		return fileDescriptor != -1;
+#endif
+	}
+	const char* MappedFile::GetData() const { return data; }
+	std::size_t MappedFile::GetSize() const { return size; }
+
+}; // namespace Util
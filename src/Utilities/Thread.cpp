@@ -4,6 +4,15 @@
 //! 
 #include "Thread.h"
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 
 
 namespace Util {
@@ -15,6 +24,7 @@ namespace Util {
 			, name(name)
 			, isStarted(false)
 			, args(nullptr)
+			, affinityCpu(-1)
 		{}
 
 		//! Destructor
@@ -30,7 +40,7 @@ namespace Util {
 		//! 
 		void Thread::Start(void* args) {
 			if (isStarted) {
-				Util::Log::Warn(name + ": Thread was requested to start when already active");
+				LOG_WARN(name + ": Thread was requested to start when already active");
 				return;
 			}
 
@@ -39,6 +49,19 @@ namespace Util {
 			thread = std::thread(&Thread::Runner, this);
 		}
 
+		//! SetAffinity
+		//! Pins the thread to the given logical processor once started. Must be called before Start
+		//! The thread is pinned before it initializes, so memory it touches first is allocated on its own NUMA node
+		//! 
+		void Thread::SetAffinity(int cpu) {
+			if (isStarted) {
+				LOG_WARN(name + ": Thread affinity must be set before the thread starts");
+				return;
+			}
+
+			affinityCpu = cpu;
+		}
+
 		//! Sleep
 		//! Pauses the thread execution for the given time
 		//! 
@@ -66,13 +89,40 @@ namespace Util {
 		//! Thread standard runner function
 		//! 
 		void Thread::Runner() {
+			if (affinityCpu >= 0 && !_ApplyAffinity()) {
+				LOG_WARN(name + ": Failed to pin thread to processor " + std::to_string(affinityCpu));
+			}
+
 			if (!Init()) {
-				Util::Log::Error(name + ": Thread failed to initialize");
+				LOG_ERROR(name + ": Thread failed to initialize");
 				return;
 			}
 
 			int retVal = Run(args);
-			Util::Log::Debug(name + ": Thread exited with code " + std::to_string(retVal));
+			LOG_DEBUG(name + ": Thread exited with code " + std::to_string(retVal));
+		}
+
+		//! _ApplyAffinity
+		//! Restricts the calling thread to the requested processor
+		//! 
+		bool Thread::_ApplyAffinity() {
+#ifdef _WIN32
+			if (affinityCpu >= 64) {
+				return false;	// Processor groups are not handled
+			}
+			return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << affinityCpu) != 0;
+#elif defined(__linux__)
+			if (affinityCpu >= CPU_SETSIZE) {
+				return false;
+			}
+
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(affinityCpu, &cpuSet);
+			return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+			return false;
+#endif
 		}
 
 }; // namespace Util
\ No newline at end of file
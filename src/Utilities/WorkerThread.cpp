@@ -1,6 +1,6 @@
 //!
 //! WorkerThread.cpp
-//! Defines an worker thread that works multiple tasks
+//! Defines a worker thread that runs the scheduling loop of its pool
 //! throughout its execution
 //! 
 #include "WorkerThread.h"
@@ -8,6 +8,17 @@
 
 namespace Util {
 
-	
+	WorkerThread::WorkerThread(std::string name, RunLoopType runLoop)
+		: Thread(name)
+		, runLoop(runLoop)
+	{}
 
-}; // namespace Util
\ No newline at end of file
+	void WorkerThread::Stop() {
+		this->Join();
+	}
+
+	int WorkerThread::Run(void* /*vArgs*/) {
+		return runLoop ? runLoop() : 0;
+	}
+
+}; // namespace Util
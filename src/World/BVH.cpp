@@ -0,0 +1,209 @@
+//!
+//! BVH.cpp
+//! Bounding volume hierarchy for accelerating ray collision queries
+//!
+#include "BVH.h"
+
+
+
+namespace World {
+
+	//! Build
+	//! Constructs the hierarchy over the given primitive bounds using a binned surface area heuristic
+	//! batchSize is the number of primitives the leaf kernel tests at once, so leaf cost is charged per batch
+	//!
+	void BVH::Build(const std::vector<Util::AABB<Util::Real>>& primBounds, int batchSize) {
+		Clear();
+		this->batchSize = std::max(1, batchSize);
+
+		int nPrims = primBounds.size();
+		if (nPrims == 0) {
+			return;
+		}
+
+		//! Precompute centroids for binning
+		std::vector<Util::Vector3<Util::Real>> centroids(nPrims);
+		primIndices.resize(nPrims);
+		for (int primI = 0; primI < nPrims; primI++) {
+			centroids[primI] = primBounds[primI].Centroid();
+			primIndices[primI] = primI;
+		}
+
+		//! A binary tree over n primitives holds at most 2n - 1 nodes
+		nodes.reserve(2 * nPrims - 1);
+
+		Node root;
+		root.leftFirst = 0;
+		root.count = nPrims;
+		nodes.push_back(root);
+		_UpdateBounds(0, primBounds);
+		_Subdivide(0, 0, primBounds, centroids);
+
+		nodes.shrink_to_fit();
+		LOG_DEBUG("BVH: Built " + std::to_string(nodes.size()) + " nodes over " + std::to_string(nPrims) + " primitives");
+	}
+
+	//! Clear
+	//! Removes all nodes from the hierarchy
+	//!
+	void BVH::Clear() {
+		nodes.clear();
+		primIndices.clear();
+	}
+
+	//! Accessors
+	//!
+	bool BVH::IsEmpty() const { return nodes.empty(); }
+	const std::vector<BVH::Node>& BVH::GetNodes() const { return nodes; }
+	const std::vector<int>& BVH::GetPrimitiveIndices() const { return primIndices; }
+
+	//! _UpdateBounds
+	//! Fits the node bounds to the primitives it contains
+	//!
+	void BVH::_UpdateBounds(int nodeIdx, const std::vector<Util::AABB<Util::Real>>& primBounds) {
+		Node& node = nodes[nodeIdx];
+		node.bounds = Util::AABB<Util::Real>();
+		for (int primI = node.leftFirst; primI < node.leftFirst + node.count; primI++) {
+			node.bounds.Grow(primBounds[primIndices[primI]]);
+		}
+	}
+
+	//! _GetBatchCount
+	//! Returns the number of kernel invocations needed to test the given number of primitives
+	//!
+	int BVH::_GetBatchCount(int primCount) const {
+		return (primCount + batchSize - 1) / batchSize;
+	}
+
+	//! _Subdivide
+	//! Recursively splits the given leaf along the lowest cost SAH plane
+	//! Falls back to a median split when oversized leaves cannot be split by cost
+	//!
+	void BVH::_Subdivide(int nodeIdx, int depth, const std::vector<Util::AABB<Util::Real>>& primBounds, const std::vector<Util::Vector3<Util::Real>>& centroids) {
+		int first = nodes[nodeIdx].leftFirst;
+		int count = nodes[nodeIdx].count;
+
+		if (count <= 1 || depth >= maxDepth - 1) {
+			return;
+		}
+
+		//! Determine centroid bounds; only these are useful for binning
+		Util::AABB<Util::Real> centroidBounds;
+		for (int primI = first; primI < first + count; primI++) {
+			centroidBounds.Grow(centroids[primIndices[primI]]);
+		}
+
+		/* ----------------------------------------------------------------
+		 * Find the lowest cost split plane over all axes
+		 * ---------------------------------------------------------------- */
+		int bestAxis = -1;
+		int bestSplit = -1;
+		double bestCost = INFINITY;
+
+		for (int axis = 0; axis < 3; axis++) {
+			double axisMin = centroidBounds.min[axis];
+			double axisMax = centroidBounds.max[axis];
+			if (axisMax - axisMin <= 0) {
+				continue;	// All centroids coincide along this axis
+			}
+
+			//! Populate bins
+			Util::AABB<Util::Real> binBounds[binCount];
+			int binCounts[binCount] = {};
+			double binScale = binCount / (axisMax - axisMin);
+
+			for (int primI = first; primI < first + count; primI++) {
+				int primIdx = primIndices[primI];
+				int binIdx = std::min(binCount - 1, (int)((centroids[primIdx][axis] - axisMin) * binScale));
+				binCounts[binIdx]++;
+				binBounds[binIdx].Grow(primBounds[primIdx]);
+			}
+
+			//! Sweep bins from both sides to gather left/right areas and counts
+			double leftArea[binCount - 1], rightArea[binCount - 1];
+			int leftCount[binCount - 1], rightCount[binCount - 1];
+			Util::AABB<Util::Real> leftBox, rightBox;
+			int leftSum = 0, rightSum = 0;
+
+			for (int binI = 0; binI < binCount - 1; binI++) {
+				leftSum += binCounts[binI];
+				leftCount[binI] = leftSum;
+				leftBox.Grow(binBounds[binI]);
+				leftArea[binI] = leftBox.SurfaceArea();
+
+				rightSum += binCounts[binCount - 1 - binI];
+				rightCount[binCount - 2 - binI] = rightSum;
+				rightBox.Grow(binBounds[binCount - 1 - binI]);
+				rightArea[binCount - 2 - binI] = rightBox.SurfaceArea();
+			}
+
+			//! Evaluate each candidate plane
+			for (int splitI = 0; splitI < binCount - 1; splitI++) {
+				if (leftCount[splitI] == 0 || rightCount[splitI] == 0) {
+					continue;
+				}
+
+				double cost = _GetBatchCount(leftCount[splitI]) * leftArea[splitI] + _GetBatchCount(rightCount[splitI]) * rightArea[splitI];
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = splitI;
+				}
+			}
+		}
+
+		/* ----------------------------------------------------------------
+		 * Partition primitives
+		 * ---------------------------------------------------------------- */
+		double parentArea = nodes[nodeIdx].bounds.SurfaceArea();
+		double leafCost = _GetBatchCount(count) * intersectCost;
+		double splitCost = (parentArea > 0) ? traversalCost + intersectCost * bestCost / parentArea : INFINITY;
+
+		int mid = -1;
+		if (bestAxis != -1 && splitCost < leafCost) {
+			//! Partition about the chosen bin boundary
+			double axisMin = centroidBounds.min[bestAxis];
+			double binScale = binCount / (centroidBounds.max[bestAxis] - axisMin);
+			int* begin = primIndices.data() + first;
+			int* end = begin + count;
+			int* split = std::partition(begin, end, [&](int primIdx) {
+				int binIdx = std::min(binCount - 1, (int)((centroids[primIdx][bestAxis] - axisMin) * binScale));
+				return binIdx <= bestSplit;
+			});
+			mid = split - primIndices.data();
+		}
+		else if (count > std::max(maxLeafSize, batchSize)) {
+			//! Cost does not justify a split, but the leaf is too large; split at the median of the widest axis
+			Util::Vector3<Util::Real> extent = centroidBounds.Extent();
+			int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+			mid = first + count / 2;
+			std::nth_element(primIndices.begin() + first, primIndices.begin() + mid, primIndices.begin() + first + count, [&](int a, int b) {
+				return centroids[a][axis] < centroids[b][axis];
+			});
+		}
+		else {
+			return;	// Remain a leaf
+		}
+
+		/* ----------------------------------------------------------------
+		 * Create children
+		 * ---------------------------------------------------------------- */
+		int leftIdx = nodes.size();
+		Node left, right;
+		left.leftFirst = first;
+		left.count = mid - first;
+		right.leftFirst = mid;
+		right.count = first + count - mid;
+		nodes.push_back(left);
+		nodes.push_back(right);
+
+		nodes[nodeIdx].leftFirst = leftIdx;
+		nodes[nodeIdx].count = 0;
+
+		_UpdateBounds(leftIdx, primBounds);
+		_UpdateBounds(leftIdx + 1, primBounds);
+		_Subdivide(leftIdx, depth + 1, primBounds, centroids);
+		_Subdivide(leftIdx + 1, depth + 1, primBounds, centroids);
+	}
+
+}; // namespace World
@@ -0,0 +1,44 @@
+//!
+//! BoxStore.cpp
+//! Packed structure-of-arrays storage of oriented box primitives
+//!
+#include "BoxStore.h"
+
+
+
+namespace World {
+
+	//! Add
+	//! Appends a box owned by the given world object
+	//!
+	void BoxStore::Add(const Box& box, int objectIdx) {
+		const Util::Real values[FIELD_COUNT] = {
+			(Util::Real)box.center.x, (Util::Real)box.center.y, (Util::Real)box.center.z,
+			(Util::Real)box.halfExtent.x, (Util::Real)box.halfExtent.y, (Util::Real)box.halfExtent.z,
+			(Util::Real)box.axes[0].x, (Util::Real)box.axes[0].y, (Util::Real)box.axes[0].z,
+			(Util::Real)box.axes[1].x, (Util::Real)box.axes[1].y, (Util::Real)box.axes[1].z,
+			(Util::Real)box.axes[2].x, (Util::Real)box.axes[2].y, (Util::Real)box.axes[2].z
+		};
+		_Append(values, objectIdx);
+	}
+
+	//! GetBounds
+	//! Returns the world axis-aligned bounding box of the given box
+	//!
+	Util::AABB<Util::Real> BoxStore::GetBounds(int boxIdx) const {
+		Util::Vector3<Util::Real> center(fields[CENTER_X][boxIdx], fields[CENTER_Y][boxIdx], fields[CENTER_Z][boxIdx]);
+
+		//! Project the oriented half extents onto the world axes
+		Util::Vector3<Util::Real> extent;
+		for (int axis = 0; axis < 3; axis++) {
+			Util::Real halfExtent = fields[HALF_EXTENT_0 + axis][boxIdx];
+			extent = extent + Util::Vector3<Util::Real>(
+				std::abs(fields[AXIS_0_X + 3 * axis][boxIdx]),
+				std::abs(fields[AXIS_0_Y + 3 * axis][boxIdx]),
+				std::abs(fields[AXIS_0_Z + 3 * axis][boxIdx])) * halfExtent;
+		}
+
+		return Util::AABB<Util::Real>(center - extent, center + extent);
+	}
+
+}; // namespace World
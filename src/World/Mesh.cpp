@@ -0,0 +1,218 @@
+//!
+//! Mesh.cpp
+//! Indexed triangle mesh with its own bounding volume hierarchy
+//!
+#include "Mesh.h"
+#include "TriangleStore.h"
+
+
+
+namespace World {
+
+	//! TriangleLanes
+	//! Triangles of a leaf gathered from the indexed buffers into kernel lanes
+	//!
+	struct TriangleLanes {
+		Lanes v0[3];
+		Lanes edge1[3];
+		Lanes edge2[3];
+	};
+
+	//! Constructor
+	//! Reorders the triangles to match the leaf order of the hierarchy so that leaves index contiguous triangles
+	//!
+	Mesh::Mesh(std::vector<float>&& vertices, std::vector<uint32_t>&& indices)
+		: vertices(std::move(vertices))
+		, indices(std::move(indices))
+	{
+		int nTriangles = GetTriangleCount();
+
+		std::vector<Util::AABB<Util::Real>> triBounds(nTriangles);
+		for (int triI = 0; triI < nTriangles; triI++) {
+			for (int corner = 0; corner < 3; corner++) {
+				Util::Vector3<Util::Real> vertex(_GetVertex(this->indices[triI * 3 + corner]));
+				triBounds[triI].Grow(vertex);
+				bounds.Grow(Util::Vector3<double>(vertex));
+			}
+		}
+
+		bvh.Build(triBounds, Lanes::width);
+		triBounds = std::vector<Util::AABB<Util::Real>>();	// Release before reordering
+
+		const std::vector<int>& order = bvh.GetPrimitiveIndices();
+		std::vector<uint32_t> reordered(this->indices.size());
+		for (int triI = 0; triI < nTriangles; triI++) {
+			for (int corner = 0; corner < 3; corner++) {
+				reordered[triI * 3 + corner] = this->indices[order[triI] * 3 + corner];
+			}
+		}
+		this->indices.swap(reordered);
+	}
+
+	//! _GatherLanes
+	//! Loads up to Lanes::width triangles starting at the given triangle into kernel lanes
+	//! Lanes past count hold NaN, which never satisfies any collision comparison
+	//!
+	static TriangleLanes _GatherLanes(const std::vector<float>& vertices, const std::vector<uint32_t>& indices, int first, int count) {
+		alignas(32) Util::Real values[9][Lanes::width];
+		for (int lane = 0; lane < Lanes::width; lane++) {
+			if (lane >= count) {
+				for (int fieldI = 0; fieldI < 9; fieldI++) {
+					values[fieldI][lane] = NAN;
+				}
+				continue;
+			}
+
+			const uint32_t* tri = &indices[(first + lane) * 3];
+			const float* v0 = &vertices[(size_t)tri[0] * 3];
+			const float* v1 = &vertices[(size_t)tri[1] * 3];
+			const float* v2 = &vertices[(size_t)tri[2] * 3];
+			for (int axis = 0; axis < 3; axis++) {
+				values[axis][lane] = v0[axis];
+				values[3 + axis][lane] = (Util::Real)v1[axis] - (Util::Real)v0[axis];
+				values[6 + axis][lane] = (Util::Real)v2[axis] - (Util::Real)v0[axis];
+			}
+		}
+
+		TriangleLanes lanes;
+		for (int axis = 0; axis < 3; axis++) {
+			lanes.v0[axis] = Lanes::LoadAligned(values[axis]);
+			lanes.edge1[axis] = Lanes::LoadAligned(values[3 + axis]);
+			lanes.edge2[axis] = Lanes::LoadAligned(values[6 + axis]);
+		}
+		return lanes;
+	}
+
+	//! IntersectNearest
+	//! Returns the index of the nearest triangle hit closer than tMax and shrinks tMax to its distance,
+	//! or -1 if none is hit
+	//!
+	int Mesh::IntersectNearest(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real& tMax) const {
+		int nearestIdx = -1;
+
+		const LaneRay ray = { Lanes(origin.x), Lanes(origin.y), Lanes(origin.z), Lanes(direction.x), Lanes(direction.y), Lanes(direction.z) };
+		const Lanes minDist(Util::collisionEpsilon<Util::Real>);
+
+		bvh.Traverse(origin, direction, tMax, [&](int first, int count) {
+			for (int triI = first; triI < first + count; triI += Lanes::width) {
+				TriangleLanes tris = _GatherLanes(vertices, indices, triI, first + count - triI);
+
+				Lanes tNear, tFar;
+				Lanes::Mask hit = TriangleStore::IntersectLanes(ray, tris.v0, tris.edge1, tris.edge2, tNear, tFar);
+
+				int laneMask = (hit & (tNear >= minDist) & (tNear < Lanes(tMax))).Bits();
+				if (laneMask == 0) {
+					continue;
+				}
+
+				alignas(32) Util::Real dists[Lanes::width];
+				tNear.StoreAligned(dists);
+				for (int lane = 0; lane < Lanes::width; lane++) {
+					if ((laneMask & (1 << lane)) && dists[lane] < tMax) {
+						tMax = dists[lane];
+						nearestIdx = triI + lane;
+					}
+				}
+			}
+			return false;
+		});
+
+		return nearestIdx;
+	}
+
+	//! IntersectAny
+	//! Returns whether the ray collides with any triangle within (0, tMax)
+	//!
+	bool Mesh::IntersectAny(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, Util::Real tMax) const {
+		bool isHit = false;
+
+		const LaneRay ray = { Lanes(origin.x), Lanes(origin.y), Lanes(origin.z), Lanes(direction.x), Lanes(direction.y), Lanes(direction.z) };
+		const Lanes minDist(Util::collisionEpsilon<Util::Real>), maxDist(tMax);
+
+		bvh.Traverse(origin, direction, tMax, [&](int first, int count) {
+			for (int triI = first; triI < first + count && !isHit; triI += Lanes::width) {
+				TriangleLanes tris = _GatherLanes(vertices, indices, triI, first + count - triI);
+
+				Lanes tNear, tFar;
+				Lanes::Mask hit = TriangleStore::IntersectLanes(ray, tris.v0, tris.edge1, tris.edge2, tNear, tFar);
+				isHit = (hit & (tNear >= minDist) & (tNear < maxDist)).Bits() != 0;
+			}
+			return isHit;
+		});
+
+		return isHit;
+	}
+
+	//! IntersectPacketNearest
+	//! Tests every ray of the packet against the mesh, shrinking packet.tMax of rays that find a closer triangle
+	//! and setting their triangleIdx entry. The packet must be padded to a multiple of Lanes::width
+	//!
+	void Mesh::IntersectPacketNearest(Util::RayPacket& packet, int* triangleIdx) const {
+		const Lanes minDist(Util::collisionEpsilon<Util::Real>);
+
+		bvh.TraversePacket(packet, [&](int first, int count) {
+			for (int rayI = 0; rayI < packet.count; rayI += Lanes::width) {
+				const LaneRay ray = {
+					Lanes::LoadAligned(&packet.originX[rayI]), Lanes::LoadAligned(&packet.originY[rayI]), Lanes::LoadAligned(&packet.originZ[rayI]),
+					Lanes::LoadAligned(&packet.dirX[rayI]), Lanes::LoadAligned(&packet.dirY[rayI]), Lanes::LoadAligned(&packet.dirZ[rayI])
+				};
+				Lanes tMax = Lanes::LoadAligned(&packet.tMax[rayI]);
+
+				//! Broadcast each triangle across the ray group
+				for (int triI = first; triI < first + count; triI++) {
+					const uint32_t* tri = &indices[triI * 3];
+					Util::Vector3<Util::Real> v0(_GetVertex(tri[0]));
+					Util::Vector3<Util::Real> edge1 = Util::Vector3<Util::Real>(_GetVertex(tri[1])) - v0;
+					Util::Vector3<Util::Real> edge2 = Util::Vector3<Util::Real>(_GetVertex(tri[2])) - v0;
+
+					const Lanes v0Lanes[3] = { Lanes(v0.x), Lanes(v0.y), Lanes(v0.z) };
+					const Lanes edge1Lanes[3] = { Lanes(edge1.x), Lanes(edge1.y), Lanes(edge1.z) };
+					const Lanes edge2Lanes[3] = { Lanes(edge2.x), Lanes(edge2.y), Lanes(edge2.z) };
+
+					Lanes tNear, tFar;
+					Lanes::Mask hit = TriangleStore::IntersectLanes(ray, v0Lanes, edge1Lanes, edge2Lanes, tNear, tFar);
+					Lanes::Mask valid = hit & (tNear >= minDist) & (tNear < tMax);
+
+					tMax = Select(valid, tNear, tMax);
+
+					//! Record the triangle for rays it is now nearest to; padding rays are never valid
+					int laneMask = valid.Bits();
+					for (int lane = 0; lane < Lanes::width; lane++) {
+						if (laneMask & (1 << lane)) {
+							triangleIdx[rayI + lane] = triI;
+						}
+					}
+				}
+
+				tMax.StoreAligned(&packet.tMax[rayI]);
+			}
+			return false;
+		});
+	}
+
+	//! Accessors
+	//!
+	int Mesh::GetTriangleCount() const { return indices.size() / 3; }
+	int Mesh::GetVertexCount() const { return vertices.size() / 3; }
+	const Util::AABB<double>& Mesh::GetBounds() const { return bounds; }
+
+	//! GetTriangleNormal
+	//! Returns the geometric normal of the given triangle, following its winding order
+	//!
+	Util::Vector3<double> Mesh::GetTriangleNormal(int triangleIdx) const {
+		const uint32_t* tri = &indices[triangleIdx * 3];
+		Util::Vector3<double> v0(_GetVertex(tri[0]));
+		Util::Vector3<double> v1(_GetVertex(tri[1]));
+		Util::Vector3<double> v2(_GetVertex(tri[2]));
+		return (v1 - v0).Cross(v2 - v0).Normalized();
+	}
+
+	//! _GetVertex
+	//! Returns the position of the given vertex
+	//!
+	Util::Vector3<float> Mesh::_GetVertex(uint32_t vertexIdx) const {
+		const float* vertex = &vertices[(size_t)vertexIdx * 3];
+		return Util::Vector3<float>(vertex[0], vertex[1], vertex[2]);
+	}
+
+}; // namespace World
@@ -0,0 +1,594 @@
+//!
+//! MeshLoader.cpp
+//! Streaming loader of triangle meshes from Wavefront OBJ and binary PLY files
+//!
+#include "MeshLoader.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+
+
+namespace World {
+
+	namespace MeshLoader {
+
+		//! VertexPlacement
+		//! Object transform reduced to an origin and three scaled, rotated axes, applied to every vertex read
+		//!
+		struct VertexPlacement {
+			Util::Vector3<double> position;
+			Util::Vector3<double> axes[3];
+
+			VertexPlacement(const Util::Transform& transform)
+				: position(transform.position)
+			{
+				axes[0] = transform.rotation.Rotate(Util::Vector3<double>::Right()) * transform.scale.x;
+				axes[1] = transform.rotation.Rotate(Util::Vector3<double>::Up()) * transform.scale.y;
+				axes[2] = transform.rotation.Rotate(Util::Vector3<double>::Forward()) * transform.scale.z;
+			}
+
+			void Append(double x, double y, double z, std::vector<float>& vertices) const {
+				Util::Vector3<double> world = position + axes[0] * x + axes[1] * y + axes[2] * z;
+				vertices.push_back((float)world.x);
+				vertices.push_back((float)world.y);
+				vertices.push_back((float)world.z);
+			}
+		};
+
+		/* ----------------------------------------------------------------
+		 * Shared helpers
+		 * ---------------------------------------------------------------- */
+
+		static bool _IsSpace(char c) {
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		static const char* _SkipSpace(const char* cursor, const char* end) {
+			while (cursor < end && _IsSpace(*cursor)) {
+				cursor++;
+			}
+			return cursor;
+		}
+
+		static const char* _FindLineEnd(const char* cursor, const char* end) {
+			const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+			return (lineEnd != nullptr) ? lineEnd : end;
+		}
+
+		//! _ValidateIndices
+		//! Returns whether every index refers to an existing vertex
+		//!
+		static bool _ValidateIndices(const std::vector<uint32_t>& indices, size_t nVertices, const std::string& path) {
+			for (uint32_t index : indices) {
+				if (index >= nVertices) {
+					LOG_ERROR("MeshLoader: Vertex index " + std::to_string(index) + " out of range in " + path);
+					return false;
+				}
+			}
+			return true;
+		}
+
+		//! _BuildMesh
+		//! Moves the loaded buffers into a mesh, building its hierarchy
+		//!
+		static std::shared_ptr<Mesh> _BuildMesh(std::vector<float>&& vertices, std::vector<uint32_t>&& indices, const std::string& path) {
+			if (indices.empty()) {
+				LOG_ERROR("MeshLoader: No triangles found in " + path);
+				return nullptr;
+			}
+
+			if (!_ValidateIndices(indices, vertices.size() / 3, path)) {
+				return nullptr;
+			}
+
+			vertices.shrink_to_fit();
+			indices.shrink_to_fit();
+
+			std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>(std::move(vertices), std::move(indices));
+			LOG_INFO("MeshLoader: Loaded " + path + " (" + std::to_string(mesh->GetVertexCount()) + " vertices, " + std::to_string(mesh->GetTriangleCount()) + " triangles)");
+			return mesh;
+		}
+
+		/* ----------------------------------------------------------------
+		 * Wavefront OBJ
+		 * Only positions (v) and faces (f) are read; polygons are fan triangulated
+		 * ---------------------------------------------------------------- */
+
+		//! _ParseNumber
+		//! Parses a number at the cursor after leading whitespace, advancing the cursor past it
+		//!
+		template <typename T>
+		static bool _ParseNumber(const char*& cursor, const char* end, T& value) {
+			cursor = _SkipSpace(cursor, end);
+			if (cursor < end && *cursor == '+') {
+				cursor++;	// Not accepted by from_chars
+			}
+
+			std::from_chars_result result = std::from_chars(cursor, end, value);
+			if (result.ec != std::errc()) {
+				return false;
+			}
+
+			cursor = result.ptr;
+			return true;
+		}
+
+		//! _LoadOBJ
+		//!
+		static std::shared_ptr<Mesh> _LoadOBJ(const Util::MappedFile& file, const std::string& path, const VertexPlacement& placement) {
+			const char* data = file.GetData();
+			const char* end = data + file.GetSize();
+
+			//! Count vertex and face records first so that the buffers are allocated once
+			size_t nVertexLines = 0;
+			size_t nFaceLines = 0;
+			for (const char* line = data; line < end; line = _FindLineEnd(line, end) + 1) {
+				const char* cursor = _SkipSpace(line, end);
+				if (end - cursor >= 2 && _IsSpace(cursor[1])) {
+					nVertexLines += (cursor[0] == 'v');
+					nFaceLines += (cursor[0] == 'f');
+				}
+			}
+
+			std::vector<float> vertices;
+			std::vector<uint32_t> indices;
+			vertices.reserve(nVertexLines * 3);
+			indices.reserve(nFaceLines * 3);	// Exact for triangulated files
+
+			//! Parse records in place
+			int lineNumber = 0;
+			int nSkippedFaces = 0;
+			for (const char* line = data; line < end; ) {
+				const char* lineEnd = _FindLineEnd(line, end);
+				const char* cursor = _SkipSpace(line, lineEnd);
+				lineNumber++;
+
+				if (lineEnd - cursor >= 2 && _IsSpace(cursor[1])) {
+					if (cursor[0] == 'v') {
+						//! v x y z [w]
+						cursor++;
+						double position[3];
+						for (double& component : position) {
+							if (!_ParseNumber(cursor, lineEnd, component)) {
+								LOG_ERROR("MeshLoader: Malformed vertex on line " + std::to_string(lineNumber) + " of " + path);
+								return nullptr;
+							}
+						}
+						placement.Append(position[0], position[1], position[2], vertices);
+					}
+					else if (cursor[0] == 'f') {
+						//! f v[/vt][/vn] ...; negative indices are relative to the latest vertex
+						cursor++;
+						int64_t nVertices = vertices.size() / 3;
+						uint32_t firstIdx = 0, prevIdx = 0;
+						int nCorners = 0;
+
+						while (true) {
+							cursor = _SkipSpace(cursor, lineEnd);
+							if (cursor >= lineEnd || *cursor == '#') {
+								break;
+							}
+
+							int64_t index;
+							if (!_ParseNumber(cursor, lineEnd, index) || index == 0 || index < -nVertices || index > UINT32_MAX) {
+								LOG_ERROR("MeshLoader: Malformed face on line " + std::to_string(lineNumber) + " of " + path);
+								return nullptr;
+							}
+							while (cursor < lineEnd && !_IsSpace(*cursor)) {
+								cursor++;	// Texture and normal indices are not used
+							}
+
+							uint32_t vertexIdx = (uint32_t)((index < 0) ? nVertices + index : index - 1);
+							if (nCorners == 0) {
+								firstIdx = vertexIdx;
+							}
+							else if (nCorners >= 2) {
+								indices.push_back(firstIdx);
+								indices.push_back(prevIdx);
+								indices.push_back(vertexIdx);
+							}
+							prevIdx = vertexIdx;
+							nCorners++;
+						}
+
+						nSkippedFaces += (nCorners < 3);
+					}
+				}
+
+				line = lineEnd + 1;
+			}
+
+			if (nSkippedFaces > 0) {
+				LOG_WARN("MeshLoader: Skipped " + std::to_string(nSkippedFaces) + " faces with fewer than 3 vertices in " + path);
+			}
+
+			return _BuildMesh(std::move(vertices), std::move(indices), path);
+		}
+
+		/* ----------------------------------------------------------------
+		 * Binary PLY
+		 * Reads x, y, z of the vertex element and the vertex_indices list of the face element;
+		 * polygons are fan triangulated and all other elements and properties are skipped
+		 * ---------------------------------------------------------------- */
+
+		enum class PlyType { INT8, UINT8, INT16, UINT16, INT32, UINT32, FLOAT32, FLOAT64, INVALID };
+
+		struct PlyProperty {
+			std::string name;
+			PlyType type = PlyType::INVALID;		// Item type for lists
+			PlyType countType = PlyType::INVALID;	// Set for lists only
+
+			bool IsList() const { return countType != PlyType::INVALID; }
+		};
+
+		struct PlyElement {
+			std::string name;
+			size_t count;
+			std::vector<PlyProperty> properties;
+
+			int FindProperty(std::string_view name) const {
+				for (int propI = 0; propI < properties.size(); propI++) {
+					if (properties[propI].name == name) {
+						return propI;
+					}
+				}
+				return -1;
+			}
+		};
+
+		static PlyType _GetPlyType(std::string_view name) {
+			if (name == "char" || name == "int8") return PlyType::INT8;
+			if (name == "uchar" || name == "uint8") return PlyType::UINT8;
+			if (name == "short" || name == "int16") return PlyType::INT16;
+			if (name == "ushort" || name == "uint16") return PlyType::UINT16;
+			if (name == "int" || name == "int32") return PlyType::INT32;
+			if (name == "uint" || name == "uint32") return PlyType::UINT32;
+			if (name == "float" || name == "float32") return PlyType::FLOAT32;
+			if (name == "double" || name == "float64") return PlyType::FLOAT64;
+			return PlyType::INVALID;
+		}
+
+		static int _GetPlyTypeSize(PlyType type) {
+			switch (type) {
+			case PlyType::INT8: case PlyType::UINT8: return 1;
+			case PlyType::INT16: case PlyType::UINT16: return 2;
+			case PlyType::INT32: case PlyType::UINT32: case PlyType::FLOAT32: return 4;
+			case PlyType::FLOAT64: return 8;
+			default: return 0;
+			}
+		}
+
+		//! _ReadPlyScalar
+		//! Reads an unaligned scalar, reversing its bytes if the file endianness differs from the host
+		//!
+		template <typename T>
+		static T _ReadPlyScalar(const char* src, bool swapBytes) {
+			char bytes[sizeof(T)];
+			std::memcpy(bytes, src, sizeof(T));
+			if (swapBytes) {
+				std::reverse(bytes, bytes + sizeof(T));
+			}
+
+			T value;
+			std::memcpy(&value, bytes, sizeof(T));
+			return value;
+		}
+
+		//! _ReadPlyValue
+		//! Reads a scalar of any type, widened to double
+		//!
+		static double _ReadPlyValue(const char* src, PlyType type, bool swapBytes) {
+			switch (type) {
+			case PlyType::INT8: return _ReadPlyScalar<int8_t>(src, swapBytes);
+			case PlyType::UINT8: return _ReadPlyScalar<uint8_t>(src, swapBytes);
+			case PlyType::INT16: return _ReadPlyScalar<int16_t>(src, swapBytes);
+			case PlyType::UINT16: return _ReadPlyScalar<uint16_t>(src, swapBytes);
+			case PlyType::INT32: return _ReadPlyScalar<int32_t>(src, swapBytes);
+			case PlyType::UINT32: return _ReadPlyScalar<uint32_t>(src, swapBytes);
+			case PlyType::FLOAT32: return _ReadPlyScalar<float>(src, swapBytes);
+			case PlyType::FLOAT64: return _ReadPlyScalar<double>(src, swapBytes);
+			default: return 0;
+			}
+		}
+
+		//! _ReadPlyIndex
+		//! Reads a vertex index, returning false if it is negative or does not fit 32 bits
+		//!
+		static bool _ReadPlyIndex(const char* src, PlyType type, bool swapBytes, uint32_t& index) {
+			double value = _ReadPlyValue(src, type, swapBytes);
+			if (!(value >= 0 && value <= UINT32_MAX)) {
+				return false;
+			}
+
+			index = (uint32_t)value;
+			return true;
+		}
+
+		//! _GetPlyMinRecordSize
+		//! Returns the size of the smallest possible record of the element, in which every list is empty
+		//!
+		static size_t _GetPlyMinRecordSize(const PlyElement& element) {
+			size_t size = 0;
+			for (const PlyProperty& property : element.properties) {
+				size += _GetPlyTypeSize(property.IsList() ? property.countType : property.type);
+			}
+			return size;
+		}
+
+		//! _ReadPlyElement
+		//! Walks every record of the element, invoking onProperty(propertyIdx, values, valueCount) for each
+		//! property, and returns the cursor past the element or nullptr if the file is truncated or a list
+		//! count is negative
+		//!
+		template <typename PropertyFn>
+		static const char* _ReadPlyElement(const PlyElement& element, const char* cursor, const char* end, bool swapBytes, PropertyFn&& onProperty) {
+			if (element.properties.empty()) {
+				return cursor;	// Records without properties occupy no bytes
+			}
+
+			for (size_t recordI = 0; recordI < element.count; recordI++) {
+				for (int propI = 0; propI < element.properties.size(); propI++) {
+					const PlyProperty& property = element.properties[propI];
+					size_t valueCount = 1;
+
+					if (property.IsList()) {
+						int countSize = _GetPlyTypeSize(property.countType);
+						if (end - cursor < countSize) {
+							return nullptr;
+						}
+
+						//! Every item takes at least a byte, which bounds the count before it is converted
+						double count = _ReadPlyValue(cursor, property.countType, swapBytes);
+						cursor += countSize;
+						if (!(count >= 0 && count <= (double)(end - cursor))) {
+							return nullptr;
+						}
+						valueCount = (size_t)count;
+					}
+
+					size_t valuesSize = valueCount * _GetPlyTypeSize(property.type);
+					if ((size_t)(end - cursor) < valuesSize) {
+						return nullptr;
+					}
+
+					onProperty(propI, cursor, valueCount);
+					cursor += valuesSize;
+				}
+			}
+			return cursor;
+		}
+
+		//! _SplitTokens
+		//! Splits a header line on whitespace
+		//!
+		static std::vector<std::string_view> _SplitTokens(const char* line, const char* lineEnd) {
+			std::vector<std::string_view> tokens;
+			const char* cursor = _SkipSpace(line, lineEnd);
+			while (cursor < lineEnd) {
+				const char* tokenEnd = cursor;
+				while (tokenEnd < lineEnd && !_IsSpace(*tokenEnd)) {
+					tokenEnd++;
+				}
+				tokens.emplace_back(cursor, tokenEnd - cursor);
+				cursor = _SkipSpace(tokenEnd, lineEnd);
+			}
+			return tokens;
+		}
+
+		//! _LoadPLY
+		//!
+		static std::shared_ptr<Mesh> _LoadPLY(const Util::MappedFile& file, const std::string& path, const VertexPlacement& placement) {
+			const char* data = file.GetData();
+			const char* end = data + file.GetSize();
+
+			/* ----------------------------------------------------------------
+			 * Header
+			 * ---------------------------------------------------------------- */
+			std::vector<PlyElement> elements;
+			bool isBigEndian = false;
+			bool hasFormat = false;
+			const char* cursor = data;
+			const char* body = nullptr;
+
+			for (int lineI = 0; cursor < end && body == nullptr; lineI++) {
+				const char* lineEnd = _FindLineEnd(cursor, end);
+				std::vector<std::string_view> tokens = _SplitTokens(cursor, lineEnd);
+				cursor = lineEnd + 1;
+
+				if (lineI == 0) {
+					if (tokens.size() != 1 || tokens[0] != "ply") {
+						LOG_ERROR("MeshLoader: Missing PLY signature in " + path);
+						return nullptr;
+					}
+					continue;
+				}
+
+				if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info") {
+					continue;
+				}
+				else if (tokens[0] == "format" && tokens.size() >= 2) {
+					if (tokens[1] == "binary_little_endian") {
+						isBigEndian = false;
+					}
+					else if (tokens[1] == "binary_big_endian") {
+						isBigEndian = true;
+					}
+					else {
+						LOG_ERROR("MeshLoader: Unsupported PLY format '" + std::string(tokens[1]) + "' in " + path + "; only binary PLY is supported");
+						return nullptr;
+					}
+					hasFormat = true;
+				}
+				else if (tokens[0] == "element" && tokens.size() == 3) {
+					PlyElement element;
+					element.name = tokens[1];
+					if (std::from_chars(tokens[2].data(), tokens[2].data() + tokens[2].size(), element.count).ec != std::errc()) {
+						LOG_ERROR("MeshLoader: Malformed PLY element count in " + path);
+						return nullptr;
+					}
+					elements.push_back(element);
+				}
+				else if (tokens[0] == "property" && !elements.empty()) {
+					PlyProperty property;
+					if (tokens.size() == 5 && tokens[1] == "list") {
+						property.countType = _GetPlyType(tokens[2]);
+						property.type = _GetPlyType(tokens[3]);
+						property.name = tokens[4];
+					}
+					else if (tokens.size() == 3) {
+						property.type = _GetPlyType(tokens[1]);
+						property.name = tokens[2];
+					}
+
+					if (property.type == PlyType::INVALID || (tokens.size() == 5 && property.countType == PlyType::INVALID) || property.name.empty()) {
+						LOG_ERROR("MeshLoader: Malformed PLY property in " + path);
+						return nullptr;
+					}
+					elements.back().properties.push_back(property);
+				}
+				else if (tokens[0] == "end_header") {
+					body = cursor;
+				}
+			}
+
+			if (body == nullptr || !hasFormat) {
+				LOG_ERROR("MeshLoader: Incomplete PLY header in " + path);
+				return nullptr;
+			}
+
+			const uint16_t endianProbe = 1;
+			const bool isHostLittleEndian = *reinterpret_cast<const uint8_t*>(&endianProbe) == 1;
+			const bool swapBytes = (isBigEndian == isHostLittleEndian);
+
+			/* ----------------------------------------------------------------
+			 * Body
+			 * ---------------------------------------------------------------- */
+			std::vector<float> vertices;
+			std::vector<uint32_t> indices;
+
+			cursor = body;
+			for (const PlyElement& element : elements) {
+				//! Reject counts the remaining bytes cannot hold before they size any buffer
+				size_t minRecordSize = _GetPlyMinRecordSize(element);
+				if (minRecordSize > 0 && element.count > (size_t)(end - cursor) / minRecordSize) {
+					LOG_ERROR("MeshLoader: PLY element '" + element.name + "' count exceeds the size of " + path);
+					return nullptr;
+				}
+
+				if (element.name == "vertex") {
+					int axisProps[3] = { element.FindProperty("x"), element.FindProperty("y"), element.FindProperty("z") };
+					for (int axisProp : axisProps) {
+						if (axisProp == -1 || element.properties[axisProp].IsList()) {
+							LOG_ERROR("MeshLoader: PLY vertex element lacks scalar x, y, z properties in " + path);
+							return nullptr;
+						}
+					}
+
+					int lastAxisProp = std::max(axisProps[0], std::max(axisProps[1], axisProps[2]));
+
+					vertices.reserve(vertices.size() + element.count * 3);
+					double position[3] = {};
+					cursor = _ReadPlyElement(element, cursor, end, swapBytes, [&](int propI, const char* values, size_t /*valueCount*/) {
+						for (int axis = 0; axis < 3; axis++) {
+							if (propI == axisProps[axis]) {
+								position[axis] = _ReadPlyValue(values, element.properties[propI].type, swapBytes);
+							}
+						}
+						if (propI == lastAxisProp) {
+							placement.Append(position[0], position[1], position[2], vertices);
+						}
+					});
+				}
+				else if (element.name == "face") {
+					int indicesProp = element.FindProperty("vertex_indices");
+					if (indicesProp == -1) {
+						indicesProp = element.FindProperty("vertex_index");
+					}
+					if (indicesProp == -1 || !element.properties[indicesProp].IsList()) {
+						LOG_ERROR("MeshLoader: PLY face element lacks a vertex_indices list in " + path);
+						return nullptr;
+					}
+
+					PlyType indexType = element.properties[indicesProp].type;
+					int indexSize = _GetPlyTypeSize(indexType);
+
+					indices.reserve(indices.size() + element.count * 3);
+					bool hasInvalidIndex = false;
+					cursor = _ReadPlyElement(element, cursor, end, swapBytes, [&](int propI, const char* values, size_t valueCount) {
+						if (propI != indicesProp || valueCount < 3) {
+							return;
+						}
+
+						//! Fan triangulate
+						uint32_t firstIdx, prevIdx, vertexIdx;
+						if (!_ReadPlyIndex(values, indexType, swapBytes, firstIdx) || !_ReadPlyIndex(values + indexSize, indexType, swapBytes, prevIdx)) {
+							hasInvalidIndex = true;
+							return;
+						}
+
+						for (size_t cornerI = 2; cornerI < valueCount; cornerI++) {
+							if (!_ReadPlyIndex(values + cornerI * indexSize, indexType, swapBytes, vertexIdx)) {
+								hasInvalidIndex = true;
+								return;
+							}
+
+							indices.push_back(firstIdx);
+							indices.push_back(prevIdx);
+							indices.push_back(vertexIdx);
+							prevIdx = vertexIdx;
+						}
+					});
+
+					if (hasInvalidIndex) {
+						LOG_ERROR("MeshLoader: Negative or out of range PLY vertex index in " + path);
+						return nullptr;
+					}
+				}
+				else {
+					cursor = _ReadPlyElement(element, cursor, end, swapBytes, [](int, const char*, size_t) {});
+				}
+
+				if (cursor == nullptr) {
+					LOG_ERROR("MeshLoader: Truncated or malformed PLY element '" + element.name + "' in " + path);
+					return nullptr;
+				}
+			}
+
+			return _BuildMesh(std::move(vertices), std::move(indices), path);
+		}
+
+		/* ----------------------------------------------------------------
+		 * Interface
+		 * ---------------------------------------------------------------- */
+
+		//! Load
+		//! Loads the mesh at the given path, selecting the format by file extension (.obj or .ply)
+		//!
+		std::shared_ptr<Mesh> Load(const std::string& path, const Util::Transform& transform) {
+			std::string extension = path.substr(std::min(path.size(), path.find_last_of('.')));
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+
+			if (extension != ".obj" && extension != ".ply") {
+				LOG_ERROR("MeshLoader: Unsupported mesh format '" + extension + "' of " + path);
+				return nullptr;
+			}
+
+			Util::MappedFile file;
+			if (!file.Open(path)) {
+				return nullptr;
+			}
+
+			VertexPlacement placement(transform);
+			return (extension == ".obj") ? _LoadOBJ(file, path, placement) : _LoadPLY(file, path, placement);
+		}
+
+	}; // namespace MeshLoader
+
+}; // namespace World
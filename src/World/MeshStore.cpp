@@ -0,0 +1,108 @@
+//!
+//! MeshStore.cpp
+//! Storage of triangle mesh references, each intersected through its own hierarchy
+//!
+#include "MeshStore.h"
+#include <algorithm>
+
+
+
+namespace World {
+
+	//! Add
+	//! Appends a mesh owned by the given world object
+	//!
+	void MeshStore::Add(const MeshRef& meshRef, int objectIdx) {
+		meshes.push_back(meshRef.mesh);
+		this->objectIdx.push_back(objectIdx);
+	}
+
+	//! Clear
+	//! Removes all meshes
+	//!
+	void MeshStore::Clear() {
+		meshes.clear();
+		objectIdx.clear();
+	}
+
+	//! Reorder
+	//! Permutes the meshes such that mesh i becomes the mesh previously at order[i]
+	//!
+	void MeshStore::Reorder(const std::vector<int>& order) {
+		if (order.size() != meshes.size()) {
+			LOG_ERROR("MeshStore: Reorder size does not match mesh count");
+			return;
+		}
+
+		std::vector<std::shared_ptr<const Mesh>> newMeshes(meshes.size());
+		std::vector<int> newObjectIdx(meshes.size());
+		for (int meshI = 0; meshI < meshes.size(); meshI++) {
+			newMeshes[meshI] = meshes[order[meshI]];
+			newObjectIdx[meshI] = objectIdx[order[meshI]];
+		}
+		meshes.swap(newMeshes);
+		objectIdx.swap(newObjectIdx);
+	}
+
+	//! IntersectNearest
+	//! Returns the index of the nearest mesh hit closer than tMax and shrinks tMax to its distance,
+	//! or -1 if none is hit. faceIdx is set to the triangle hit within that mesh
+	//!
+	int MeshStore::IntersectNearest(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real& tMax, int& faceIdx) const {
+		int nearestIdx = -1;
+		for (int meshI = first; meshI < first + count; meshI++) {
+			int triangleIdx = meshes[meshI]->IntersectNearest(origin, direction, tMax);
+			if (triangleIdx != -1) {
+				nearestIdx = meshI;
+				faceIdx = triangleIdx;
+			}
+		}
+		return nearestIdx;
+	}
+
+	//! IntersectAny
+	//! Returns whether the ray collides with any mesh in [first, first + count) within (0, tMax)
+	//!
+	bool MeshStore::IntersectAny(const Util::Vector3<Util::Real>& origin, const Util::Vector3<Util::Real>& direction, int first, int count, Util::Real tMax) const {
+		for (int meshI = first; meshI < first + count; meshI++) {
+			if (meshes[meshI]->IntersectAny(origin, direction, tMax)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	//! IntersectPacketNearest
+	//! Tests every ray of the packet against the meshes in [first, first + count)
+	//! Rays that find a closer mesh have their tMax shrunk, nearestIdx set to the mesh index and faceIdx
+	//! set to the triangle hit within that mesh
+	//!
+	void MeshStore::IntersectPacketNearest(Util::RayPacket& packet, int first, int count, int* nearestIdx, int* faceIdx) const {
+		for (int meshI = first; meshI < first + count; meshI++) {
+			int triangleIdx[Util::RayPacket::maxSize];
+			std::fill(triangleIdx, triangleIdx + packet.count, -1);
+			meshes[meshI]->IntersectPacketNearest(packet, triangleIdx);
+
+			for (int rayI = 0; rayI < packet.count; rayI++) {
+				if (triangleIdx[rayI] != -1) {
+					nearestIdx[rayI] = meshI;
+					faceIdx[rayI] = triangleIdx[rayI];
+				}
+			}
+		}
+	}
+
+	//! Accessors
+	//!
+	int MeshStore::GetCount() const { return meshes.size(); }
+	int MeshStore::GetObjectIndex(int meshIdx) const { return objectIdx[meshIdx]; }
+
+	//! GetBounds
+	//! Returns the bounding box of the given mesh
+	//!
+	Util::AABB<Util::Real> MeshStore::GetBounds(int meshIdx) const {
+		const Util::AABB<double>& bounds = meshes[meshIdx]->GetBounds();
+		return Util::AABB<Util::Real>(Util::Vector3<Util::Real>(bounds.min), Util::Vector3<Util::Real>(bounds.max));
+	}
+
+}; // namespace World
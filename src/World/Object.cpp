@@ -15,15 +15,96 @@ namespace World {
 		, material(MaterialMgr::GetMaterial(materialID))
 		, transform(transform)
 		, shape(shape)
+		, primitive(_BuildPrimitive(shape, transform))
+		, hasGeometry(_HasUnitPrimitive(shape))
+	{}
+
+	//! Constructor
+	//! The mesh is expected to already be placed in world space by the given transform
+	//! 
+	Object::Object(MaterialMgr::MATERIAL_ID materialID, Util::Transform& transform, std::shared_ptr<const Mesh> mesh)
+		: materialID(materialID)
+		, material(MaterialMgr::GetMaterial(materialID))
+		, transform(transform)
+		, shape(ShapeType::MESH)
+		, primitive(MeshRef{ mesh })
+		, hasGeometry(mesh != nullptr && mesh->GetTriangleCount() > 0)
 	{}
 
 	//! Accessors/Mutators
 	//! 
+	MaterialMgr::MATERIAL_ID Object::GetMaterialID() const { return materialID; }
 	const MaterialMgr::Material& Object::GetMaterial() const { return material; }
 	const Util::Transform& Object::GetTransform() const { return transform; }
 	const Util::Vector3<double>& Object::GetPosition() const { return transform.position; }
 	const Util::Rotation& Object::GetRotation() const { return transform.rotation; }
 	const Util::Vector3<double>& Object::GetScale() const { return transform.scale; }
 	ShapeType Object::GetShapeType() const { return shape; }
+	const Primitive& Object::GetPrimitive() const { return primitive; }
+	bool Object::HasGeometry() const { return hasGeometry; }
+
+	//! GetBounds
+	//! Returns the world space bounding box of the object
+	//! 
+	Util::AABB<double> Object::GetBounds() const {
+		return World::GetBounds(primitive);
+	}
+
+	//! _BuildPrimitive
+	//! Places the unit primitive of the given shape in world space
+	//! 
+	Primitive Object::_BuildPrimitive(ShapeType shape, const Util::Transform& transform) {
+		const Util::Vector3<double>& scale = transform.scale;
+		double maxScale = std::max(scale.x, std::max(scale.y, scale.z));
+
+		switch (shape) {
+		case ShapeType::SPHERE:
+			return Sphere{ transform.position, maxScale };
+
+		case ShapeType::PLANE:
+			return Plane{ transform.position, transform.rotation.Rotate(Util::Vector3<double>::Up()) };
+
+		case ShapeType::CUBE:
+		case ShapeType::RECTANGLE: {
+			Box box;
+			box.center = transform.position;
+			box.halfExtent = (shape == ShapeType::CUBE) ? Util::Vector3<double>(maxScale, maxScale, maxScale) * 0.5 : scale * 0.5;
+			box.axes[0] = transform.rotation.Rotate(Util::Vector3<double>::Right());
+			box.axes[1] = transform.rotation.Rotate(Util::Vector3<double>::Up());
+			box.axes[2] = transform.rotation.Rotate(Util::Vector3<double>::Forward());
+			return box;
+		}
+
+		case ShapeType::TRIANGLE: {
+			auto place = [&](double x, double y) {
+				return transform.position + transform.rotation.Rotate(Util::Vector3<double>(x * scale.x, y * scale.y, 0));
+			};
+			return Triangle{ place(-0.5, -0.5), place(0.5, -0.5), place(0, 0.5) };
+		}
+
+		case ShapeType::MESH:
+		default:
+			//! Meshes are constructed from their loaded geometry instead
+			LOG_ERROR("Object: Shape type " + std::to_string((int)shape) + " has no unit primitive");
+			return Triangle{ transform.position, transform.position, transform.position };	// Placeholder; the object reports no geometry
+		}
+	}
+
+	//! _HasUnitPrimitive
+	//! Returns whether _BuildPrimitive can place the given shape from a transform alone
+	//! 
+	bool Object::_HasUnitPrimitive(ShapeType shape) {
+		switch (shape) {
+		case ShapeType::SPHERE:
+		case ShapeType::PLANE:
+		case ShapeType::CUBE:
+		case ShapeType::RECTANGLE:
+		case ShapeType::TRIANGLE:
+			return true;
+
+		default:
+			return false;
+		}
+	}
 
 }; // namespace World
\ No newline at end of file
@@ -0,0 +1,22 @@
+//!
+//! PlaneStore.cpp
+//! Packed structure-of-arrays storage of infinite plane primitives
+//!
+#include "PlaneStore.h"
+
+
+
+namespace World {
+
+	//! Add
+	//! Appends a plane owned by the given world object
+	//!
+	void PlaneStore::Add(const Plane& plane, int objectIdx) {
+		const Util::Real values[FIELD_COUNT] = {
+			(Util::Real)plane.point.x, (Util::Real)plane.point.y, (Util::Real)plane.point.z,
+			(Util::Real)plane.normal.x, (Util::Real)plane.normal.y, (Util::Real)plane.normal.z
+		};
+		_Append(values, objectIdx);
+	}
+
+}; // namespace World
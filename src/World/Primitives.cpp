@@ -0,0 +1,57 @@
+//!
+//! Primitives.cpp
+//! World space geometric primitives and their scalar intersection routines
+//!
+#include "Primitives.h"
+
+
+
+namespace World {
+
+	//! HasVolume
+	//! Returns whether the primitive encloses a volume, such that rays entering it leave through another surface
+	//!
+	bool HasVolume(const Primitive& primitive) {
+		return std::holds_alternative<Sphere>(primitive) || std::holds_alternative<Box>(primitive);
+	}
+
+	//! GetBounds
+	//! Returns the world space bounding box of the primitive
+	//!
+	Util::AABB<double> GetBounds(const Sphere& sphere) {
+		const Util::Vector3<double> extent(sphere.radius, sphere.radius, sphere.radius);
+		return Util::AABB<double>(sphere.center - extent, sphere.center + extent);
+	}
+
+	//! Planes are unbounded
+	Util::AABB<double> GetBounds(const Plane& /*plane*/) {
+		return Util::AABB<double>(Util::Vector3<double>(-INFINITY, -INFINITY, -INFINITY), Util::Vector3<double>(INFINITY, INFINITY, INFINITY));
+	}
+
+	Util::AABB<double> GetBounds(const Box& box) {
+		//! Project the oriented half extents onto the world axes
+		Util::Vector3<double> extent;
+		for (int axis = 0; axis < 3; axis++) {
+			const Util::Vector3<double>& boxAxis = box.axes[axis];
+			extent = extent + Util::Vector3<double>(std::abs(boxAxis.x), std::abs(boxAxis.y), std::abs(boxAxis.z)) * box.halfExtent[axis];
+		}
+		return Util::AABB<double>(box.center - extent, box.center + extent);
+	}
+
+	Util::AABB<double> GetBounds(const Triangle& triangle) {
+		Util::AABB<double> bounds;
+		bounds.Grow(triangle.v0);
+		bounds.Grow(triangle.v1);
+		bounds.Grow(triangle.v2);
+		return bounds;
+	}
+
+	Util::AABB<double> GetBounds(const MeshRef& meshRef) {
+		return meshRef.mesh->GetBounds();
+	}
+
+	Util::AABB<double> GetBounds(const Primitive& primitive) {
+		return std::visit([](const auto& prim) { return GetBounds(prim); }, primitive);
+	}
+
+}; // namespace World
@@ -0,0 +1,32 @@
+//!
+//! SphereStore.cpp
+//! Packed structure-of-arrays storage of sphere primitives
+//!
+#include "SphereStore.h"
+
+
+
+namespace World {
+
+	//! Add
+	//! Appends a sphere owned by the given world object
+	//!
+	void SphereStore::Add(const Sphere& sphere, int objectIdx) {
+		const Util::Real values[FIELD_COUNT] = {
+			(Util::Real)sphere.center.x, (Util::Real)sphere.center.y, (Util::Real)sphere.center.z,
+			(Util::Real)sphere.radius
+		};
+		_Append(values, objectIdx);
+	}
+
+	//! GetBounds
+	//! Returns the bounding box of the given sphere
+	//!
+	Util::AABB<Util::Real> SphereStore::GetBounds(int sphereIdx) const {
+		Util::Vector3<Util::Real> center(fields[CENTER_X][sphereIdx], fields[CENTER_Y][sphereIdx], fields[CENTER_Z][sphereIdx]);
+		Util::Real radius = fields[RADIUS][sphereIdx];
+		Util::Vector3<Util::Real> extent(radius, radius, radius);
+		return Util::AABB<Util::Real>(center - extent, center + extent);
+	}
+
+}; // namespace World
@@ -0,0 +1,40 @@
+//!
+//! TriangleStore.cpp
+//! Packed structure-of-arrays storage of triangle primitives
+//!
+#include "TriangleStore.h"
+
+
+
+namespace World {
+
+	//! Add
+	//! Appends a triangle owned by the given world object
+	//!
+	void TriangleStore::Add(const Triangle& triangle, int objectIdx) {
+		const Util::Vector3<double> edge1 = triangle.v1 - triangle.v0;
+		const Util::Vector3<double> edge2 = triangle.v2 - triangle.v0;
+		const Util::Real values[FIELD_COUNT] = {
+			(Util::Real)triangle.v0.x, (Util::Real)triangle.v0.y, (Util::Real)triangle.v0.z,
+			(Util::Real)edge1.x, (Util::Real)edge1.y, (Util::Real)edge1.z,
+			(Util::Real)edge2.x, (Util::Real)edge2.y, (Util::Real)edge2.z
+		};
+		_Append(values, objectIdx);
+	}
+
+	//! GetBounds
+	//! Returns the bounding box of the given triangle
+	//!
+	Util::AABB<Util::Real> TriangleStore::GetBounds(int triangleIdx) const {
+		Util::Vector3<Util::Real> v0(fields[V0_X][triangleIdx], fields[V0_Y][triangleIdx], fields[V0_Z][triangleIdx]);
+		Util::Vector3<Util::Real> edge1(fields[EDGE1_X][triangleIdx], fields[EDGE1_Y][triangleIdx], fields[EDGE1_Z][triangleIdx]);
+		Util::Vector3<Util::Real> edge2(fields[EDGE2_X][triangleIdx], fields[EDGE2_Y][triangleIdx], fields[EDGE2_Z][triangleIdx]);
+
+		Util::AABB<Util::Real> bounds;
+		bounds.Grow(v0);
+		bounds.Grow(v0 + edge1);
+		bounds.Grow(v0 + edge2);
+		return bounds;
+	}
+
+}; // namespace World
@@ -16,12 +16,19 @@ namespace World {
 		return this->objects.size();
 	}
 
+	//! GetVersion
+	//! Returns a counter that changes whenever the rendered contents of the world change
+	//! 
+	uint64_t World::GetVersion() const {
+		return this->version;
+	}
+
 	//! GetObject
 	//! Returns a reference to the object at the specified index
 	//! 
 	Object* World::GetObject(int index) {
 		if (index >= GetObjectCount()) {
-			Util::Log::Error("Attempted to retrieve world object using invalid index");
+			LOG_ERROR("Attempted to retrieve world object using invalid index");
 			return nullptr;
 		}
 
@@ -33,7 +40,7 @@ namespace World {
 	//! 
 	const Object* World::GetObject(int index) const {
 		if (index >= GetObjectCount()) {
-			Util::Log::Error("Attempted to retrieve world object using invalid index");
+			LOG_ERROR("Attempted to retrieve world object using invalid index");
 			return nullptr;
 		}
 
@@ -42,9 +49,37 @@ namespace World {
 
 	//! AddObject
 	//! Adds the specified object to the renderable world
+	//! Objects without geometry are rejected, so they never enter the acceleration structures
 	//! 
-	void World::AddObject(Object& obj) {
+	bool World::AddObject(Object& obj) {
+		if (!obj.HasGeometry()) {
+			LOG_ERROR("World: Rejected an object without geometry");
+			return false;
+		}
+
+		int objIdx = this->objects.size();
 		this->objects.push_back(obj);
+		this->version++;
+
+		//! Mirror the object into the bucket of its primitive type
+		std::visit([&](const auto& primitive) {
+			using PrimitiveType = std::decay_t<decltype(primitive)>;
+			auto addTo = [&](auto& bucket) {
+				if constexpr (std::is_same_v<typename std::decay_t<decltype(bucket)>::PrimitiveType, PrimitiveType>) {
+					bucket.Add(primitive, objIdx);
+				}
+			};
+			std::apply([&](auto&... bucket) { (addTo(bucket), ...); }, buckets);
+		}, obj.GetPrimitive());
+		return true;
+	}
+
+	//! UpdateBVH
+	//! Rebuilds the hierarchy of every bucket whose primitives have changed since the last build
+	//! Must not be called while collision queries are in flight
+	//! 
+	void World::UpdateBVH() {
+		std::apply([](auto&... bucket) { (bucket.Update(), ...); }, buckets);
 	}
 
 }; // namespace World
\ No newline at end of file
@@ -4,24 +4,183 @@
 //! 
 
 #include "Engine.h"
+#include <thread>
 
 
-constexpr int nRenderThreads = 16;	// TODO: Parameterize/default to all(-1)
 
+//! _GetFramePath
+//! Replaces the first '#' of the pattern with the zero-padded frame number
+//! 
+static std::string _GetFramePath(const std::string& pattern, int frameI) {
+	size_t markerPos = pattern.find('#');
+	std::string number = std::to_string(frameI);
+	number.insert(0, number.size() < 4 ? 4 - number.size() : 0, '0');
+	return pattern.substr(0, markerPos) + number + pattern.substr(markerPos + 1);
+}
+
+//! Usage: Raytracer [--threads N] [--pin] [--tile-size N] [--target-fps N] [--deadline-ms N]
+//!                  [--tonemap clamp|reinhard] [--exposure E] [--gamma] [--progressive]
+//!                  [--headless N] [--output path.ppm|.png|.pfm] [mesh.obj|mesh.ply ...]
+//! Renders with one thread per hardware thread unless overridden; --pin pins each render thread to a processor
+//! --target-fps lowers the render resolution as needed to hold the given frame rate
+//! --deadline-ms bounds the render time of each frame; tiles not started in time show the previous frame
+//! --tonemap, --exposure and --gamma select how radiance maps to display colors; by default it clips at white
+//! --progressive averages frames while nothing moves, converging to an anti-aliased image
+//! --headless renders N frames without a window and writes the last one to --output (default frame.png);
+//! a '#' in the output path writes every frame, with the '#' replaced by the frame number
+//! Each given mesh is loaded into the scene in front of the camera
+//! 
+int main(int argc, char* argv[]) {
+	/* ----------------------------------------------------------------
+	* Parse options
+	* ---------------------------------------------------------------- */
+	int nRenderThreads = std::max(1u, std::thread::hardware_concurrency());
+	bool pinRenderThreads = false;
+	int tileSize = 0;
+	double targetFps = 0;
+	double deadlineMs = 0;
+	Renderer::TonemapSettings tonemapSettings;
+	bool isProgressive = false;
+	int nHeadlessFrames = 0;
+	std::string outputPath = "frame.png";
+	std::vector<std::string> meshPaths;
 
+	for (int argI = 1; argI < argc; argI++) {
+		std::string arg = argv[argI];
+		if (arg == "--threads" && argI + 1 < argc) {
+			nRenderThreads = std::atoi(argv[++argI]);
+			if (nRenderThreads < 1) {
+				LOG_ERROR("main: Invalid render thread count " + std::string(argv[argI]));
+				return 1;
+			}
+		}
+		else if (arg == "--pin") {
+			pinRenderThreads = true;
+		}
+		else if (arg == "--tile-size" && argI + 1 < argc) {
+			tileSize = std::atoi(argv[++argI]);
+		}
+		else if (arg == "--target-fps" && argI + 1 < argc) {
+			targetFps = std::atof(argv[++argI]);
+			if (!(targetFps > 0)) {
+				LOG_ERROR("main: Invalid target frame rate " + std::string(argv[argI]));
+				return 1;
+			}
+		}
+		else if (arg == "--tonemap" && argI + 1 < argc) {
+			std::string op = argv[++argI];
+			if (op == "clamp") {
+				tonemapSettings.op = Renderer::TonemapOperator::CLAMP;
+			}
+			else if (op == "reinhard") {
+				tonemapSettings.op = Renderer::TonemapOperator::REINHARD;
+			}
+			else {
+				LOG_ERROR("main: Unknown tonemap operator " + op);
+				return 1;
+			}
+		}
+		else if (arg == "--exposure" && argI + 1 < argc) {
+			tonemapSettings.exposure = (float)std::atof(argv[++argI]);
+			if (!(tonemapSettings.exposure > 0)) {
+				LOG_ERROR("main: Invalid exposure " + std::string(argv[argI]));
+				return 1;
+			}
+		}
+		else if (arg == "--gamma") {
+			tonemapSettings.encodeGamma = true;
+		}
+		else if (arg == "--progressive") {
+			isProgressive = true;
+		}
+		else if (arg == "--headless" && argI + 1 < argc) {
+			nHeadlessFrames = std::atoi(argv[++argI]);
+			if (nHeadlessFrames < 1) {
+				LOG_ERROR("main: Invalid headless frame count " + std::string(argv[argI]));
+				return 1;
+			}
+		}
+		else if (arg == "--output" && argI + 1 < argc) {
+			outputPath = argv[++argI];
+		}
+		else if (arg == "--deadline-ms" && argI + 1 < argc) {
+			deadlineMs = std::atof(argv[++argI]);
+			if (!(deadlineMs > 0)) {
+				LOG_ERROR("main: Invalid frame deadline " + std::string(argv[argI]));
+				return 1;
+			}
+		}
+		else {
+			meshPaths.push_back(arg);
+		}
+	}
 
-int main() {
 	/* ----------------------------------------------------------------
 	* Initialize engine
 	* ---------------------------------------------------------------- */
-	Engine::Engine engine = Engine::Engine(nRenderThreads);
+	Engine::Engine engine = Engine::Engine(nRenderThreads, pinRenderThreads, nHeadlessFrames > 0);
 	
 	bool success = engine.Init();
 	if (!success) {
-		Util::Log::Error("main: Engine initialization failed");
+		LOG_ERROR("main: Engine initialization failed");
+		return 1;
+	}
+
+	if (tileSize != 0 && !engine.SetTileSize(tileSize)) {
+		return 1;
+	}
+
+	if (targetFps > 0) {
+		engine.SetFrameTimeBudget(1 / targetFps);
+	}
+
+	if (deadlineMs > 0 && !engine.SetFrameDeadline(deadlineMs / 1000)) {
 		return 1;
 	}
 
+	if (!engine.SetTonemapSettings(tonemapSettings)) {
+		return 1;
+	}
+
+	if (isProgressive && !engine.SetProgressive(true)) {
+		return 1;
+	}
+
+	Util::Vector3<double> meshPos(0, 0, 5);
+	Util::Rotation meshRot(0, 0, 0);
+	Util::Vector3<double> meshScale(1, 1, 1);
+
+	for (const std::string& meshPath : meshPaths) {
+		Util::Transform meshTransform(meshPos, meshRot, meshScale);
+		if (!engine.AddMesh(meshPath, MaterialMgr::MATERIAL_ID::TEST_MAT, meshTransform)) {
+			return 1;
+		}
+	}
+
+	/* ----------------------------------------------------------------
+	* Headless batch
+	* ---------------------------------------------------------------- */
+	if (nHeadlessFrames > 0) {
+		bool isSequence = outputPath.find('#') != std::string::npos;
+		std::chrono::duration<double> renderTime(0);
+
+		for (int frameI = 0; frameI < nHeadlessFrames; frameI++) {
+			auto startTime = std::chrono::steady_clock::now();
+			if (!engine.DisplayFrame()) {
+				return 1;
+			}
+			renderTime += std::chrono::steady_clock::now() - startTime;
+
+			if (isSequence && !engine.SaveFrame(_GetFramePath(outputPath, frameI))) {
+				return 1;
+			}
+		}
+
+		std::cout << "Rendered " << nHeadlessFrames << " frames in " << renderTime.count() << " s ("
+			<< 1000 * renderTime.count() / nHeadlessFrames << " ms per frame)" << std::endl;
+		return (isSequence || engine.SaveFrame(outputPath)) ? 0 : 1;
+	}
+
 	/* ----------------------------------------------------------------
 	* Main loop
 	* ---------------------------------------------------------------- */